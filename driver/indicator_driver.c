@@ -18,19 +18,224 @@
 #include <linux/platform_device.h>   
 #include <linux/poll.h>
 #include <linux/io.h>
-#include <linux/mutex.h>
+#include <linux/mm.h>
 #include <linux/slab.h>
+#include <linux/hrtimer.h>
+#include <linux/ktime.h>
+#include <linux/spinlock.h>
+#include <linux/uaccess.h>
+#include <linux/seqlock.h>
+#include <linux/percpu.h>
+#include <linux/workqueue.h>
+#include <linux/leds.h>
+#include <linux/idr.h>
+#include <linux/debugfs.h>
+#include <linux/vmalloc.h>
+#include <linux/sched.h>
+#include <linux/kref.h>
 #include "indicator_driver.h" 
 
+#define CREATE_TRACE_POINTS
+#include "indicator_trace.h"
+
+//-----------------------------------------------------------------------------
+
+#define REGION_SIZE (REGISTER_COUNT * sizeof(u32))
+#define REGION_ALL  GENMASK(REGISTER_COUNT - 1, 0)
+#define HISTORY_SIZE PAGE_ALIGN(sizeof(struct indicator_history))
+
+/* device names carry the physical address with %pad digits, sans 0x */
+#define DEVICE_NAME_FMT     DRIVER_NAME "_%0*llx"
+#define DEVICE_NAME_ARGS(_mem)                                         \
+    (int)(sizeof((_mem)->start) * 2), (unsigned long long)(_mem)->start
+
+//-----------------------------------------------------------------------------
+//  Описание регистров IP-Core.
+//-----------------------------------------------------------------------------
+
+#define REG_ACCESS_READ     0b01U
+#define REG_ACCESS_WRITE    0b10U
+
+// Описание регистра (индекс в таблице = смещение / 4).
+struct indicator_reg
+{
+    u32 offset;             /* offset in the register window */
+    u32 access;             /* REG_ACCESS_READ | REG_ACCESS_WRITE */
+    bool owned;             /* changed only by the driver */
+};
+
+static const struct indicator_reg indicator_regs[REGISTER_COUNT] =
+{
+    [INDICATOR_OFFSET / 4] =
+    {
+        .offset = INDICATOR_OFFSET,
+        .access = REG_ACCESS_READ | REG_ACCESS_WRITE,
+        .owned  = true,
+    },
+};
+
+//-----------------------------------------------------------------------------
+
+// Описание поля регистра (из него создается атрибут SysFS).
+struct indicator_field
+{
+    const char * name;      /* sysfs attribute name */
+    u32 reg;                /* index in indicator_regs */
+    u32 shift;              /* position of the lowest bit */
+    u32 mask;               /* bits of the field in the register */
+    u32 max;                /* largest value of the field */
+    umode_t mode;           /* sysfs permissions */
+};
+
+#define INDICATOR_FIELD(_name, _offset, _shift, _width, _mode)         \
+    {                                                                  \
+        .name  = "indicator_" #_name,                                  \
+        .reg   = (_offset) / 4,                                        \
+        .shift = (_shift),                                             \
+        .mask  = ((u32)((1ULL << (_width)) - 1)) << (_shift),          \
+        .max   = (u32)((1ULL << (_width)) - 1),                        \
+        .mode  = (_mode),                                              \
+    }
+
+enum indicator_field_id
+{
+    FIELD_INDICATOR_LED,
+    FIELD_COUNT
+};
+
+static const struct indicator_field indicator_fields[FIELD_COUNT] =
+{
+    /* indicator-led main file, 7-0 bits */
+    [FIELD_INDICATOR_LED] = INDICATOR_FIELD(indicator_led, INDICATOR_OFFSET,
+                                            0, 8, 0644),
+};
+
+//-----------------------------------------------------------------------------
+
+#define LED_CHANNELS 3
+
+// Канал цвета (бит поля индикатора) для подсистемы LED.
+struct indicator_channel
+{
+    const char * color;     /* color part of the LED name */
+    u32 bit;                /* bit inside FIELD_INDICATOR_LED */
+};
+
+static const struct indicator_channel indicator_channels[LED_CHANNELS] =
+{
+    { .color = "red",   .bit = 0 },
+    { .color = "green", .bit = 1 },
+    { .color = "blue",  .bit = 2 },
+};
+
+//-----------------------------------------------------------------------------
+
+// План обращения: индексы регистров в порядке доступа.
+struct access_plan
+{
+    u32 count;
+    u32 index[REGISTER_COUNT];
+};
+
+//-----------------------------------------------------------------------------
+
+// Учет отображений окна регистров. Живет, пока есть отображения,
+// поэтому переживает отвязку устройства (ip_core освобождает devres).
+struct region_mappings
+{
+    struct kref ref;            /* the device and every mapping */
+    atomic_t count;             /* user mappings of the register window */
+    atomic_t stale;             /* a mapping was closed since the last check */
+};
+
 //-----------------------------------------------------------------------------
 
 // Локальный регион (массив слов).
 struct local_region
 {
-    u32 reg[REGISTER_COUNT];    /* region of registers */    
-    struct mutex access_mutex;  /* mutex for read/write operations */
+    spinlock_t access_lock;     /* serializes writers, taken from hardirq */
+    unsigned long flags;        /* irq state saved by the current writer */
+    seqcount_t seq;             /* lets readers snapshot without the lock */
+    bool timed;                 /* the two fields below are measured */
+    u64 locked_at;              /* when the current writer got the lock */
+    u64 wait_ns;                /* how long it waited for the lock */
+    u8 source;                  /* enum indicator_source of the writer */
+    s32 pid;                    /* and its process, for the history */
+    
+    u32 shadow[REGISTER_COUNT]; /* values last latched by the driver */
+    unsigned long shadow_valid; /* bitmask of shadow copies in sync */
+    struct region_mappings * maps;  /* user mappings of the window */
+};
+
+//-----------------------------------------------------------------------------
+
+// Проигрыватель шаблонов цвета (по таймеру высокого разрешения).
+struct pattern_engine
+{
+    struct hrtimer timer;               /* latches every step itself */
+    spinlock_t lock;                    /* protects the fields below */
+    struct indicator_pattern pattern;   /* pattern being played */
+    u32 step;                           /* index of the next step */
+    u32 round;                          /* finished rounds */
+    bool active;
+    bool removed;                       /* device is going, no new starts */
+};
+
+//-----------------------------------------------------------------------------
+
+// Отложенная запись региона (хранится только последнее значение).
+struct commit_slot
+{
+    spinlock_t lock;                    /* protects reg, pending and dead */
+    u32 reg[REGISTER_COUNT];            /* latest values posted */
+    unsigned long pending;              /* registers not committed yet */
+    s32 pid;                            /* process of the last poster */
+    struct work_struct work;            /* commits reg to the hardware */
+    struct workqueue_struct * wq;       /* ordered, one per device */
+    bool dead;                          /* wq is being destroyed */
+};
+
+//-----------------------------------------------------------------------------
+
+struct ip_core;
+
+// Канал цвета, зарегистрированный как led_classdev.
+struct indicator_led
+{
+    struct led_classdev cdev;
+    struct ip_core * led;
+    u32 mask;                           /* channel bit in the register */
+    char name[LED_MAX_NAME_SIZE];
+};
+
+//-----------------------------------------------------------------------------
+
+// Счетчики обращений (по одному экземпляру на процессор).
+struct indicator_stats
+{
+    u64 reads;              /* read() of the char device */
+    u64 writes;             /* write() of the char device */
+    u64 sysfs;              /* sysfs show/store */
+    u64 mmio_reads;         /* ioread32 issued */
+    u64 mmio_writes;        /* iowrite32 issued */
+    u64 writes_skipped;     /* writes coalesced by the shadow */
+    u64 einval;             /* requests rejected with -EINVAL */
+    u64 wait_ns;            /* total time waited for access_lock */
+    u64 wait_max_ns;
+    u64 hold_ns;            /* total time access_lock was held */
+    u64 hold_max_ns;
 };
 
+#define STAT_INC(_led, _field)      this_cpu_inc((_led)->stats->_field)
+#define STAT_ADD(_led, _field, _v)  this_cpu_add((_led)->stats->_field, (_v))
+
+// Обновить максимум счетчика текущего процессора.
+#define STAT_MAX(_led, _field, _v)                                     \
+    do {                                                               \
+        if ((_v) > this_cpu_read((_led)->stats->_field))               \
+            this_cpu_write((_led)->stats->_field, (_v));               \
+    } while (0)
+
 //-----------------------------------------------------------------------------
 
 // Параметры драйвера для взаимодействия с IP-Core.
@@ -39,21 +244,45 @@ struct ip_core
     struct resource * mem;       /* physical memory */
     void __iomem * io_base;      /* kernel space memory */
     struct local_region region; 
+    struct pattern_engine pattern;
+    struct access_plan read_plan;   /* readable or writable registers */
+    struct access_plan write_plan;  /* writable registers */
+    struct commit_slot commit;      /* O_NONBLOCK writes */
+    struct indicator_led leds[LED_CHANNELS];    /* LED class devices */
+    u32 led_count;                              /* registered of them */
+    
+    struct indicator_stats __percpu * stats;
+    bool timing;                /* stats of access_lock wait and hold */
+    
+    struct indicator_history * history;    /* vmalloc_user, mapped by readers */
+    atomic_t history_seq;                   /* seq of the last entry taken */
+    struct dentry * debugfs;                /* per-device debugfs directory */
+    
+    wait_queue_head_t change_wait;  /* woken on every region change */
+    atomic_t change_seq;            /* counter of region changes */
+    struct work_struct notify;      /* sysfs_notify() out of IRQ context */
     
     struct device * dt_device;   /* device created form the device tree */
     struct device * device;      /* device associated with char_device */
     dev_t devt;                 /* our char device number */
     struct cdev char_device;    /* our char device */
 };
+
 //-----------------------------------------------------------------------------
 
-/* queue for polling */
-static DECLARE_WAIT_QUEUE_HEAD(indicator_read_wait);
-static DECLARE_WAIT_QUEUE_HEAD(indicator_write_wait);
+// Контекст открытого файла символьного устройства.
+struct indicator_file
+{
+    struct ip_core * led;
+    int seen_seq;               /* change_seq at the last read */
+};
 
 //-----------------------------------------------------------------------------
 
 static struct class * ipcore_driver_class;   /* char device class */
+static dev_t ipcore_devt;                    /* major and first minor */
+static DEFINE_IDA(ipcore_minors);            /* minors in use */
+static struct dentry * ipcore_debugfs;       /* debugfs root of the driver */
 
 //-----------------------------------------------------------------------------
 
@@ -65,329 +294,1506 @@ static void __iomem * get_address(struct ip_core * led, u32 offset)
 
 //-----------------------------------------------------------------------------
 
-// Прочитать регистры в локальный регион.
-static void region_read(struct device * dev)
+// Оповестить ожидающих в poll() на атрибутах SysFS.
+static void region_notify(struct work_struct * work)
+{
+    struct ip_core * led = container_of(work, struct ip_core, notify);
+    u32 i;
+
+    sysfs_notify(&led->device->kobj, NULL, "region");
+    for (i = 0; i < FIELD_COUNT; i++)
+        sysfs_notify(&led->device->kobj, NULL, indicator_fields[i].name);
+}
+
+//-----------------------------------------------------------------------------
+
+// Сообщить об изменении региона (допустим контекст прерывания).
+static void region_changed(struct ip_core * led)
+{
+    atomic_inc(&led->change_seq);
+    wake_up_interruptible(&led->change_wait);
+    /* a burst of changes collapses into one pending notification */
+    schedule_work(&led->notify);
+}
+
+//-----------------------------------------------------------------------------
+
+// Процесс, от имени которого изменяется регион (0 - контекст прерывания).
+static s32 history_pid(void)
+{
+    return in_task() ? task_tgid_nr(current) : 0;
+}
+
+//-----------------------------------------------------------------------------
+
+// Записать изменение регистра в историю (без блокировок).
+static void history_record(struct ip_core * led, u32 index, u8 source, 
+                           s32 pid, u32 old, bool old_valid, u32 value)
+{
+    struct indicator_history * hist = led->history;
+    struct indicator_history_entry * entry;
+    u32 seq = atomic_inc_return(&led->history_seq);
+    u32 head;
+
+    /* seq 0 marks an entry being written, skip it on wrap-around */
+    if (unlikely(seq == 0))
+        seq = atomic_inc_return(&led->history_seq);
+
+    entry = &hist->ring[(seq - 1) & (INDICATOR_HISTORY_ENTRIES - 1)];
+
+    WRITE_ONCE(entry->seq, 0);
+    smp_wmb();
+    entry->pid     = pid;
+    entry->time_ns = ktime_get_ns();
+    entry->source  = source;
+    entry->flags   = old_valid ? INDICATOR_HISTORY_OLD_VALID : 0;
+    entry->offset  = indicator_regs[index].offset;
+    entry->old     = old;
+    entry->value   = value;
+    smp_wmb();
+    WRITE_ONCE(entry->seq, seq);
+
+    /* head never goes back, whatever order the entries complete in */
+    head = READ_ONCE(hist->head);
+    while ((s32)(seq - head) > 0)
+    {
+        u32 prev = cmpxchg(&hist->head, head, seq);
+        if (prev == head)
+            break;
+        head = prev;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+// Сбросить теневую копию (регистры изменены в обход драйвера).
+static void shadow_invalidate(struct ip_core * led)
+{
+    u32 i;
+
+    for (i = 0; i < REGISTER_COUNT; i++)
+        clear_bit(i, &led->region.shadow_valid);
+}
+
+//-----------------------------------------------------------------------------
+
+// Проверить, совпадает ли теневая копия регистра с оборудованием.
+static bool shadow_usable(struct ip_core * led, u32 index)
+{
+    struct region_mappings * maps = led->region.maps;
+
+    /* stores through mmap() bypass the shadow */
+    if (atomic_read(&maps->count))
+        return false;
+
+    /* user space could have stored anything through a closed mapping */
+    if (atomic_read(&maps->stale) && atomic_xchg(&maps->stale, 0))
+        shadow_invalidate(led);
+
+    return test_bit(index, &led->region.shadow_valid);
+}
+
+//-----------------------------------------------------------------------------
+
+// Прервать шаблон записью другого источника (под region_lock).
+static void pattern_halt(struct ip_core * led)
+{
+    unsigned long flags;
+
+    /* the timer sees the flag and doesn't restart */
+    spin_lock_irqsave(&led->pattern.lock, flags);
+    led->pattern.active = false;
+    spin_unlock_irqrestore(&led->pattern.lock, flags);
+}
+
+//-----------------------------------------------------------------------------
+
+// Прочитать регистр (под region_lock или внутри снимка).
+static u32 reg_read(struct ip_core * led, u32 index)
+{
+    const struct indicator_reg * reg = &indicator_regs[index];
+
+    /* write-only and driver-owned registers are served from the shadow */
+    if (!(reg->access & REG_ACCESS_READ) || 
+        (reg->owned && shadow_usable(led, index)))
+        return led->region.shadow[index];
+
+    STAT_INC(led, mmio_reads);
+    return ioread32(get_address(led, reg->offset));
+}
+
+//-----------------------------------------------------------------------------
+
+// Записать регистр, пропуская неизменное значение (под region_lock).
+static bool reg_write(struct ip_core * led, u32 index, u32 value)
+{
+    bool usable = shadow_usable(led, index);
+
+    /* the last writer wins, a running pattern would overwrite it */
+    if (led->region.source != INDICATOR_SRC_PATTERN)
+        pattern_halt(led);
+
+    if (usable && led->region.shadow[index] == value)
+    {
+        STAT_INC(led, writes_skipped);
+        return false;
+    }
+
+    STAT_INC(led, mmio_writes);
+    iowrite32(value, get_address(led, indicator_regs[index].offset));
+    history_record(led, index, led->region.source, led->region.pid,
+                   led->region.shadow[index], usable, value);
+    led->region.shadow[index] = value;
+    set_bit(index, &led->region.shadow_valid);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+// Начать изменение региона от имени источника source.
+static void region_lock(struct ip_core * led, u8 source)
+{
+    /* the clock is read only for the statistics or enabled events */
+    bool stats = READ_ONCE(led->timing);
+    bool timed = stats || trace_indicator_region_write_enabled() ||
+                 trace_indicator_sysfs_write_enabled();
+    u64 start = timed ? ktime_get_ns() : 0;
+    unsigned long flags;
+
+    /* 
+     * The pattern timer writes from hardirq. With interrupts off the 
+     * writer isn't preempted either, so the readers never spin on it.
+     */
+    spin_lock_irqsave(&led->region.access_lock, flags);
+    write_seqcount_begin(&led->region.seq);
+
+    led->region.flags     = flags;
+    led->region.timed     = timed;
+    led->region.locked_at = timed ? ktime_get_ns() : 0;
+    led->region.wait_ns   = led->region.locked_at - start;
+    led->region.source    = source;
+    led->region.pid       = history_pid();
+
+    if (stats)
+    {
+        STAT_ADD(led, wait_ns, led->region.wait_ns);
+        STAT_MAX(led, wait_max_ns, led->region.wait_ns);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+// Завершить изменение региона.
+static void region_unlock(struct ip_core * led)
+{
+    u64 hold_ns;
+
+    if (led->region.timed && READ_ONCE(led->timing))
+    {
+        hold_ns = ktime_get_ns() - led->region.locked_at;
+        STAT_ADD(led, hold_ns, hold_ns);
+        STAT_MAX(led, hold_max_ns, hold_ns);
+    }
+
+    write_seqcount_end(&led->region.seq);
+    spin_unlock_irqrestore(&led->region.access_lock, led->region.flags);
+}
+
+//-----------------------------------------------------------------------------
+
+// Прочитать снимок регистров из маски which (без блокировки) и вернуть
+// время, потерянное на повторы снимка (0, если трассировка выключена).
+static u64 region_read(struct device * dev, u32 * reg, unsigned long which)
 {   
     struct ip_core * led    = dev_get_drvdata(dev);
-    void __iomem   * addr   = get_address(led, 0x00U);
-    u32 mask    = BITMASK_REGISTERS;   /* bitmask of the available registers */
-    int index   = 0;
+    const struct access_plan * plan = &led->read_plan;
+    bool trace = trace_indicator_region_read_enabled();
+    bool timed = trace || trace_indicator_sysfs_read_enabled();
+    u64 mmio[REGISTER_COUNT];
+    u64 start = 0, pass = 0;
+    unsigned int seq;
+    u32 index;
+    u32 i;
+
+    /* registers missing from the plan read as zero */
+    memset(reg, 0, REGION_SIZE);
+
+    if (timed)
+        start = ktime_get_ns();
     
-    for (; mask != 0x00U; mask >>= 2)
+    /* retry if a writer changed the region during the snapshot */
+    do
     {
-        if (mask & 0b01U)           /* available for read */
-            led->region.reg[index++] = ioread32(addr); 
-    
-        addr += 4;
+        seq = read_seqcount_begin(&led->region.seq);
+        if (timed)
+            pass = ktime_get_ns();
+
+        for (i = 0; i < plan->count; i++)
+        {
+            index = plan->index[i];
+            if (!(which & BIT(index)))
+                continue;
+
+            if (trace)
+                mmio[i] = ktime_get_ns();
+
+            reg[index] = reg_read(led, index);
+
+            if (trace)
+                mmio[i] = ktime_get_ns() - mmio[i];
+        }
+    } while (read_seqcount_retry(&led->region.seq, seq));
+
+    if (!trace)
+        return pass - start;
+
+    /* readers don't take the lock, they wait only by retrying */
+    for (i = 0; i < plan->count; i++)
+    {
+        index = plan->index[i];
+        if (!(which & BIT(index)))
+            continue;
+
+        trace_indicator_region_read(dev, indicator_regs[index].offset, 
+                                    reg[index], pass - start, mmio[i]);
     }
+
+    return pass - start;
 }
 
 //-----------------------------------------------------------------------------
 
-// Записать регистры из локального региона.
-static void region_write(struct device * dev)
+// Записать регистры из маски which (под region_lock).
+static bool region_write(struct device * dev, const u32 * reg, 
+                         unsigned long which)
 {   
     struct ip_core * led   = dev_get_drvdata(dev);
-    void __iomem   * addr  = get_address(led, 0x00U);
-    u32 mask    = BITMASK_REGISTERS;   /* bitmask of the available registers */
-    int index   = 0;
+    const struct access_plan * plan = &led->write_plan;
+    bool trace  = trace_indicator_region_write_enabled();
+    bool changed = false;
+    u64 start = 0;
+    u32 index;
+    u32 i;
     
-    for (; mask != 0x00U; mask >>= 2)
+    for (i = 0; i < plan->count; i++)
+    {
+        index = plan->index[i];
+        if (!(which & BIT(index)))
+            continue;
+
+        if (trace)
+            start = ktime_get_ns();
+
+        changed |= reg_write(led, index, reg[index]);
+
+        if (trace)
+            trace_indicator_region_write(dev, indicator_regs[index].offset, 
+                                         reg[index], led->region.wait_ns,
+                                         ktime_get_ns() - start);
+    }
+
+    return changed;
+}
+
+//-----------------------------------------------------------------------------
+
+// Составить планы чтения и записи по таблице регистров.
+static void build_access_plans(struct ip_core * led)
+{
+    u32 index;
+
+    led->read_plan.count  = 0;
+    led->write_plan.count = 0;
+
+    for (index = 0; index < REGISTER_COUNT; index++)
+    {
+        if (indicator_regs[index].access)
+            led->read_plan.index[led->read_plan.count++] = index;
+
+        if (indicator_regs[index].access & REG_ACCESS_WRITE)
+            led->write_plan.index[led->write_plan.count++] = index;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+// Применить значение поля к машинному слову.
+static u32 apply_parameter(u32 reg, const struct indicator_field * field,
+                           u32 value)
+{
+    reg &= ~field->mask;                /* reset to zero necessary bits */
+    reg |= value << field->shift;       /* set register with new value */
+
+    return reg;
+}
+
+//-----------------------------------------------------------------------------
+
+// Определить выход значения за пределы поля.
+static bool check_if_within_field(const struct indicator_field * field,
+                                  unsigned long value)
+{
+    return value <= field->max;
+}
+
+//-----------------------------------------------------------------------------
+
+// Проверить доступность регистра по смещению.
+static bool check_register(u32 offset, u32 access)
+{
+    if (offset % 4 || offset >= REGISTER_COUNT * 4)
+        return false;
+
+    return (indicator_regs[offset / 4].access & access) == access;
+}
+
+//-----------------------------------------------------------------------------
+
+// Применить пакет операций чтение-модификация-запись.
+static int region_rmw(struct ip_core * led, struct indicator_rmw_batch * batch)
+{
+    struct device * dev = led->device;
+    struct indicator_rmw_op * op;
+    bool trace = trace_indicator_region_write_enabled();
+    bool changed = false;
+    u64 start = 0;
+    u32 value;
+    u32 i;
+
+    if (batch->count > INDICATOR_RMW_MAX)
+    {
+        dev_err(dev, "incorrect batch length: %u\n", batch->count);
+        STAT_INC(led, einval);
+        return -EINVAL;
+    }
+
+    /* validate the whole batch before touching the hardware */
+    for (i = 0; i < batch->count; i++)
+    {
+        op = &batch->ops[i];
+        if (!check_register(op->offset, op->mask ? REG_ACCESS_WRITE 
+                                                 : REG_ACCESS_READ))
+        {
+            dev_err(dev, "incorrect batch operation #%u: offset 0x%x "
+                "mask 0x%x\n", i, op->offset, op->mask);
+            STAT_INC(led, einval);
+            return -EINVAL;
+        }
+    }
+
+    region_lock(led, INDICATOR_SRC_IOCTL);
+    for (i = 0; i < batch->count; i++)
     {
-        if (mask & 0b10U)          /* available for write */
-            iowrite32(led->region.reg[index++], addr);
-                
-        addr += 4;
+        if (trace)
+            start = ktime_get_ns();
+
+        op      = &batch->ops[i];
+        op->old = reg_read(led, op->offset / 4);
+        if (!op->mask)
+            continue;
+
+        value = (op->old & ~op->mask) | (op->value & op->mask);
+        if (value != op->old)
+            changed |= reg_write(led, op->offset / 4, value);
+
+        if (trace)
+            trace_indicator_region_write(dev, op->offset, value, 
+                                         led->region.wait_ns,
+                                         ktime_get_ns() - start);
     }
+    region_unlock(led);
+
+    if (changed)
+        region_changed(led);
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+// Чтение для функций SysFS.
+static ssize_t sysfs_read(struct device * dev, char * buf,
+                        const struct indicator_field * field)
+{
+    struct ip_core * led = dev_get_drvdata(dev);
+    bool trace = trace_indicator_sysfs_read_enabled();
+    u32 read_val, len;
+    u32 reg[REGISTER_COUNT];
+    char tmp[32];
+    u64 start = 0, wait_ns;
+    
+    STAT_INC(led, sysfs);
+    if (trace)
+        start = ktime_get_ns();
+
+    wait_ns  = region_read(dev, reg, BIT(field->reg));
+    read_val = reg[field->reg];
+
+    if (trace)
+        trace_indicator_sysfs_read(dev, indicator_regs[field->reg].offset, 
+                                   read_val, wait_ns, 
+                                   ktime_get_ns() - start - wait_ns);
+
+    read_val &= field->mask;                /* get only necessary bits */
+    read_val >>= field->shift;              /* make pretty print */
+    len =  snprintf(tmp, sizeof(tmp), "0x%x\n", read_val);
+    memcpy(buf, tmp, len);
+    
+    return len;
 }
 
 //-----------------------------------------------------------------------------
 
-// Определить битовое смещение по маске.
-static u32 get_mask_rank(u32 mask)
-{
-    u32 count = 0;
-    
-    while (!((mask >> count) & 1))
-            count++;
-            
-    return count;
-}
+// Запись для функций SysFS.
+static ssize_t sysfs_write(struct device * dev, const char * buf,
+                        size_t count, const struct indicator_field * field)
+{
+    struct ip_core * led   = dev_get_drvdata(dev);
+    u32 addr_offset        = indicator_regs[field->reg].offset;
+    void __iomem   * addr  = get_address(led, addr_offset);
+    unsigned long tmp;
+    bool changed;
+    u64 wait_ns, mmio_ns = 0;
+    u32 value;
+    int ret;
+    
+    STAT_INC(led, sysfs);
+    ret = kstrtoul(buf, 0, &tmp);
+    if (ret < 0)
+    {
+        STAT_INC(led, einval);
+        return ret;
+    }
+    
+    if (!check_if_within_field(field, tmp))
+    {
+        dev_warn(dev, "Invalid value {0x%lx} for address {0x%p}\n", 
+                tmp, addr);
+        STAT_INC(led, einval);
+        return -EINVAL;
+    }
+
+    /* don't lose updates of concurrent char device writers */
+    region_lock(led, INDICATOR_SRC_SYSFS);
+    value = apply_parameter(reg_read(led, field->reg), field, (u32) tmp);
+    changed = reg_write(led, field->reg, value);
+    wait_ns = led->region.wait_ns;
+    if (led->region.timed)
+        mmio_ns = ktime_get_ns() - led->region.locked_at;
+    region_unlock(led);
+
+    trace_indicator_sysfs_write(dev, addr_offset, value, wait_ns, mmio_ns);
+
+    if (changed)
+        region_changed(led);
+
+    return count;
+}
+
+//-----------------------------------------------------------------------------
+//  Проигрыватель шаблонов.
+//-----------------------------------------------------------------------------
+
+// Шаг шаблона: записать цвет в поле индикатора как любой другой 
+// писатель (контекст прерывания таймера).
+static enum hrtimer_restart pattern_step(struct hrtimer * timer)
+{
+    struct pattern_engine * engine = container_of(timer, 
+                                                  struct pattern_engine,
+                                                  timer);
+    struct ip_core * led = container_of(engine, struct ip_core, pattern);
+    const struct indicator_field * field;
+    enum hrtimer_restart ret = HRTIMER_NORESTART;
+    const struct indicator_step * step;
+    u32 reg[REGISTER_COUNT];
+    bool changed = false;
+    bool latch = false;
+    u32 color = 0;
+
+    field = &indicator_fields[FIELD_INDICATOR_LED];
+
+    /* a writer that stops the pattern holds this lock too */
+    region_lock(led, INDICATOR_SRC_PATTERN);
+
+    spin_lock(&engine->lock);
+    if (!engine->active)
+        goto out;
+
+    step  = &engine->pattern.steps[engine->step];
+    color = step->color;
+    latch = true;
+
+    if (++engine->step == engine->pattern.count)
+    {
+        engine->step = 0;
+        engine->round++;
+        
+        /* finite pattern leaves the last color latched */
+        if (engine->pattern.repeat && 
+            engine->round == engine->pattern.repeat)
+        {
+            engine->active = false;
+            goto out;
+        }
+    }
+
+    hrtimer_forward_now(timer, ms_to_ktime(step->duration_ms));
+    ret = HRTIMER_RESTART;
+
+out:
+    spin_unlock(&engine->lock);
+
+    if (latch)
+    {
+        reg[field->reg] = apply_parameter(reg_read(led, field->reg), field,
+                                          color);
+        changed = region_write(led->device, reg, BIT(field->reg));
+    }
+
+    region_unlock(led);
+
+    if (changed)
+        region_changed(led);
+
+    return ret;
+}
+
+//-----------------------------------------------------------------------------
+
+// Остановить проигрывание шаблона.
+static void pattern_stop(struct ip_core * led)
+{
+    unsigned long flags;
+
+    spin_lock_irqsave(&led->pattern.lock, flags);
+    led->pattern.active = false;
+    spin_unlock_irqrestore(&led->pattern.lock, flags);
+
+    /* the color of the last step is still latched */
+    hrtimer_cancel(&led->pattern.timer);
+}
+
+//-----------------------------------------------------------------------------
+
+// Запустить проигрывание шаблона.
+static int pattern_start(struct ip_core * led,
+                        const struct indicator_pattern * pattern)
+{
+    struct device * dev = led->device;
+    unsigned long flags;
+    u32 i;
+
+    if (pattern->count == 0 || pattern->count > INDICATOR_PATTERN_MAX)
+    {
+        dev_err(dev, "incorrect pattern length: %u\n", pattern->count);
+        STAT_INC(led, einval);
+        return -EINVAL;
+    }
+
+    for (i = 0; i < pattern->count; i++)
+    {
+        if (!check_if_within_field(&indicator_fields[FIELD_INDICATOR_LED],
+                                   pattern->steps[i].color) ||
+            pattern->steps[i].duration_ms == 0)
+        {
+            dev_err(dev, "incorrect pattern step #%u\n", i);
+            STAT_INC(led, einval);
+            return -EINVAL;
+        }
+    }
+
+    pattern_stop(led);
+
+    spin_lock_irqsave(&led->pattern.lock, flags);
+    /* remove has stopped the timer for good */
+    if (led->pattern.removed)
+    {
+        spin_unlock_irqrestore(&led->pattern.lock, flags);
+        return -ENODEV;
+    }
+
+    led->pattern.pattern = *pattern;
+    led->pattern.step    = 0;
+    led->pattern.round   = 0;
+    led->pattern.active  = true;
+    spin_unlock_irqrestore(&led->pattern.lock, flags);
+
+    /* the first step is latched right away */
+    hrtimer_start(&led->pattern.timer, ktime_set(0, 0), HRTIMER_MODE_REL);
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+//  Отложенная запись.
+//-----------------------------------------------------------------------------
+
+// Зафиксировать последнее отложенное значение в оборудовании.
+static void commit_work(struct work_struct * work)
+{
+    struct commit_slot * slot = container_of(work, struct commit_slot, work);
+    struct ip_core * led = container_of(slot, struct ip_core, commit);
+    u32 reg[REGISTER_COUNT];
+    unsigned long pending;
+    bool changed = false;
+
+    region_lock(led, INDICATOR_SRC_COMMIT);
+
+    spin_lock(&slot->lock);
+    pending = slot->pending;
+    if (pending)
+        memcpy(reg, slot->reg, REGION_SIZE);
+    slot->pending = 0;
+    /* the history names the writer, not the kworker */
+    led->region.pid = slot->pid;
+    spin_unlock(&slot->lock);
+
+    if (pending)
+        changed = region_write(led->device, reg, pending);
+
+    region_unlock(led);
+
+    if (changed)
+        region_changed(led);
+}
+
+//-----------------------------------------------------------------------------
+
+// Отложить запись регистров из маски which и вернуться сразу.
+static int commit_post(struct ip_core * led, const u32 * reg,
+                       unsigned long which)
+{
+    struct commit_slot * slot = &led->commit;
+    unsigned long flags;
+    u32 i;
+
+    /* a newer value simply replaces the one not committed yet */
+    spin_lock_irqsave(&slot->lock, flags);
+    /* the descriptor outlives cdev_del(), the device is being removed */
+    if (slot->dead)
+    {
+        spin_unlock_irqrestore(&slot->lock, flags);
+        return -ENODEV;
+    }
+
+    for (i = 0; i < REGISTER_COUNT; i++)
+    {
+        if (which & BIT(i))
+            slot->reg[i] = reg[i];
+    }
+    slot->pending |= which;
+    slot->pid      = history_pid();
+    /* queued under the lock, so remove either drains it or refuses it */
+    queue_work(slot->wq, &slot->work);
+    spin_unlock_irqrestore(&slot->lock, flags);
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+// Отменить отложенную запись регистров из маски which 
+// (под region_lock, перед синхронной записью).
+static void commit_drop(struct ip_core * led, unsigned long which)
+{
+    spin_lock(&led->commit.lock);
+    led->commit.pending &= ~which;
+    spin_unlock(&led->commit.lock);
+}
+
+//-----------------------------------------------------------------------------
+
+// Синхронно записать регистры из маски which.
+static void region_commit(struct ip_core * led, u8 source, const u32 * reg,
+                          unsigned long which)
+{
+    bool changed;
+
+    region_lock(led, source);
+    /* these values are newer than any posted for the same registers */
+    commit_drop(led, which);
+    changed = region_write(led->device, reg, which);
+    region_unlock(led);
+
+    /* rewriting the latched values is not a change */
+    if (changed)
+        region_changed(led);
+}
+
+//-----------------------------------------------------------------------------
+//  Подсистема LED.
+//-----------------------------------------------------------------------------
+
+// Задать яркость канала (вызывается подсистемой LED, в том числе 
+// из триггеров в атомарном контексте).
+static void indicator_led_set(struct led_classdev * cdev,
+                             enum led_brightness value)
+{
+    struct indicator_led * channel = container_of(cdev, struct indicator_led,
+                                                  cdev);
+    struct ip_core * led = channel->led;
+    u32 index = indicator_fields[FIELD_INDICATOR_LED].reg;
+    bool changed;
+    u32 reg;
+
+    /* triggers share the register with the other channels and writers */
+    region_lock(led, INDICATOR_SRC_LED);
+    reg = reg_read(led, index);
+    reg = value ? (reg | channel->mask) : (reg & ~channel->mask);
+    changed = reg_write(led, index, reg);
+    region_unlock(led);
+
+    if (changed)
+        region_changed(led);
+}
+
+//-----------------------------------------------------------------------------
+
+// Запросить яркость канала.
+static enum led_brightness indicator_led_get(struct led_classdev * cdev)
+{
+    struct indicator_led * channel = container_of(cdev, struct indicator_led,
+                                                  cdev);
+    struct ip_core * led = channel->led;
+    u32 index = indicator_fields[FIELD_INDICATOR_LED].reg;
+    unsigned int seq;
+    u32 reg;
+
+    do
+    {
+        seq = read_seqcount_begin(&led->region.seq);
+        reg = reg_read(led, index);
+    } while (read_seqcount_retry(&led->region.seq, seq));
+
+    return (reg & channel->mask) ? LED_ON : LED_OFF;
+}
+
+//-----------------------------------------------------------------------------
+
+// Зарегистрировать каналы цвета в подсистеме LED.
+static int indicator_leds_register(struct ip_core * led)
+{
+    const struct indicator_field * field;
+    struct device * dev = led->dt_device;
+    struct indicator_led * channel;
+    u32 i;
+    int ret;
+
+    field = &indicator_fields[FIELD_INDICATOR_LED];
+    led->led_count = 0;
+
+    for (i = 0; i < LED_CHANNELS; i++)
+    {
+        channel = &led->leds[i];
+
+        channel->led  = led;
+        channel->mask = BIT(indicator_channels[i].bit) << field->shift;
+
+        /* devicename:color:function, as the LED naming scheme wants */
+        snprintf(channel->name, sizeof(channel->name), "%s:%s:status",
+                 dev_name(led->device), indicator_channels[i].color);
+        channel->cdev.name = channel->name;
+
+        channel->cdev.max_brightness = LED_ON;
+        channel->cdev.brightness = indicator_led_get(&channel->cdev);
+        channel->cdev.brightness_set = indicator_led_set;
+        channel->cdev.brightness_get = indicator_led_get;
+        /* unloading the driver leaves the color latched, as before */
+        channel->cdev.flags = LED_RETAIN_AT_SHUTDOWN;
+
+        /* unregistered by devres after ip_core_remove() */
+        ret = devm_led_classdev_register(dev, &channel->cdev);
+        if (ret < 0)
+        {
+            dev_err(dev, "can't register LED %s\n", channel->cdev.name);
+            return ret;
+        }
+
+        led->led_count++;
+    }
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+//  Функции символьного устройства.
+//-----------------------------------------------------------------------------
+
+// Запрос контекста для символьного устройства.
+static int indicator_open(struct inode * inode, struct file * filp)
+{
+    struct ip_core * led = (struct ip_core *)container_of(inode->i_cdev,
+                                                         struct ip_core,
+                                                         char_device);
+    struct indicator_file * file;
+
+    file = kzalloc(sizeof(*file), GFP_KERNEL);
+    if (!file)
+        return -ENOMEM;
+
+    /* only changes made after open wake up the poller */
+    file->led      = led;
+    file->seen_seq = atomic_read(&led->change_seq);
+    filp->private_data = file;
+    
+    return 0;    
+}
+
+//-----------------------------------------------------------------------------
+
+// Освобождение контекста символьного устройства.
+static int indicator_release(struct inode * inode, struct file * filp)
+{
+    kfree(filp->private_data);
+    filp->private_data = NULL;
+    
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+// Определить окно обращения к региону и маску его регистров.
+static int region_window(struct ip_core * led, loff_t * pos, size_t * count,
+                         unsigned long * which)
+{
+    struct device * dev = led->device;
+
+    /* 
+     * A transfer of exactly the whole region is the original interface:
+     * it always starts at offset 0 and doesn't move the file position
+     * (the callers decide that from the length before it is clamped).
+     */
+    if (*count == REGION_SIZE)
+        *pos = 0;
+
+    if (*pos < 0 || *pos % 4 || *count % 4 || *pos > REGION_SIZE)
+    {
+        dev_err(dev, "incorrect region window: offset %lld, length %zu\n",
+            (long long) *pos, *count);
+        STAT_INC(led, einval);
+        return -EINVAL;
+    }
+
+    *count = min_t(size_t, *count, REGION_SIZE - *pos);
+    *which = *count ? GENMASK((*pos + *count) / 4 - 1, *pos / 4) : 0;
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+// Позиционирование в регионе (смещение в байтах, кратно регистру).
+static loff_t indicator_llseek(struct file * filp, loff_t offset, int whence)
+{
+    return fixed_size_llseek(filp, offset, whence, REGION_SIZE);
+}
+
+//-----------------------------------------------------------------------------
+
+// Чтение из символьного устройства (read, pread, readv).
+static ssize_t indicator_read_iter(struct kiocb * iocb, struct iov_iter * to)
+{
+    struct indicator_file * file = iocb->ki_filp->private_data;
+    struct ip_core * led   = file->led;
+    struct device  * dev   = led->device;
+    size_t count           = iov_iter_count(to);
+    loff_t pos             = iocb->ki_pos;
+    bool whole             = count == REGION_SIZE;
+    u32 reg[REGISTER_COUNT];
+    unsigned long which;
+    int seq;
+    int ret;
+
+    ret = region_window(led, &pos, &count, &which);
+    if (ret < 0 || !which)
+        return ret;
+
+    /* changes racing with this read will be reported by the next poll */
+    seq = atomic_read(&led->change_seq);
+    /* one snapshot serves every segment of the vector */
+    region_read(dev, reg, which);
+    if (copy_to_iter((char *) reg + pos, count, to) != count)
+    {
+        dev_err(dev, "can't copy local region to user\n");
+        return -EFAULT;
+    }
+    
+    STAT_INC(led, reads);
+    file->seen_seq = seq;
+
+    /* a longer read is clamped, but must still reach the end of file */
+    if (!whole)
+        iocb->ki_pos = pos + count;
+
+    return count;
+}
+
+//-----------------------------------------------------------------------------
+
+// Запись в символьное устройство (write, pwrite, writev).
+static ssize_t indicator_write_iter(struct kiocb * iocb, struct iov_iter * from)
+{
+    struct indicator_file * file = iocb->ki_filp->private_data;
+    struct ip_core * led   = file->led;
+    struct device  * dev   = led->device;
+    size_t count           = iov_iter_count(from);
+    loff_t pos             = iocb->ki_pos;
+    bool whole             = count == REGION_SIZE;
+    u32 reg[REGISTER_COUNT];
+    unsigned long which;
+    int ret;
+
+    ret = region_window(led, &pos, &count, &which);
+    if (ret < 0)
+        return ret;
+
+    /* the tail of the write would be dropped silently */
+    if (count != iov_iter_count(from))
+    {
+        dev_err(dev, "write past the end of the region\n");
+        STAT_INC(led, einval);
+        return -EINVAL;
+    }
+
+    if (!which)
+        return 0;
+
+    /* may fault, so done before taking the lock */
+    if (copy_from_iter((char *) reg + pos, count, from) != count)
+    {
+        dev_err(dev, "can't copy data from user to local region\n");
+        return -EFAULT;
+    }
+
+    if (!whole)
+        iocb->ki_pos = pos + count;
+
+    /* real-time callers never wait for the lock or the bus */
+    if (iocb->ki_filp->f_flags & O_NONBLOCK)
+    {
+        ret = commit_post(led, reg, which);
+        if (ret < 0)
+            return ret;
+
+        STAT_INC(led, writes);
+        return count;
+    }
+
+    /* every segment of the vector is written under one lock hold */
+    region_commit(led, INDICATOR_SRC_CHARDEV, reg, which);
+    STAT_INC(led, writes);
+    
+    return count;  
+}
+
+//-----------------------------------------------------------------------------
+
+// Дождаться фиксации отложенных записей.
+static int indicator_fsync(struct file * filp, loff_t start, loff_t end,
+                           int datasync)
+{
+    struct indicator_file * file = filp->private_data;
+
+    flush_work(&file->led->commit.work);
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+// Ожидание очереди символьным устройством.
+static unsigned int indicator_poll(struct file * filp,
+                            struct poll_table_struct * wait)
+{
+    struct indicator_file * file = filp->private_data;
+    struct ip_core * led = file->led;
+    unsigned int mask = 0;
+
+    poll_wait(filp, &led->change_wait, wait);
+    
+    /* 
+     * The region is readable only when it was changed since 
+     * this file read it last time. Stores made through mmap() 
+     * bypass the driver and aren't reported.
+     * 
+     * It's is possible at any time to write to
+     * the region to configure the behavior of the 
+     * IP core.  
+     */
+    if (atomic_read(&led->change_seq) != file->seen_seq)
+        mask |= POLLIN | POLLRDNORM;
+
+    mask |= POLLOUT | POLLWRNORM;
+    
+    return mask;
+}
+
+//-----------------------------------------------------------------------------
+
+// Управление символьным устройством.
+static long indicator_ioctl(struct file * filp, unsigned int cmd,
+                            unsigned long arg)
+{
+    struct indicator_file * file = filp->private_data;
+    struct ip_core * led   = file->led;
+    struct indicator_pattern * pattern;
+    struct indicator_rmw_batch * batch;
+    int ret;
+
+    /* the descriptor outlives cdev_del(), the device is being removed */
+    if (READ_ONCE(led->pattern.removed))
+        return -ENODEV;
+
+    switch (cmd)
+    {
+    case INDICATOR_IOC_SET_PATTERN:
+        pattern = memdup_user((void __user *)arg, sizeof(*pattern));
+        if (IS_ERR(pattern))
+            return PTR_ERR(pattern);
+
+        ret = pattern_start(led, pattern);
+        kfree(pattern);
+        return ret;
+
+    case INDICATOR_IOC_STOP_PATTERN:
+        pattern_stop(led);
+        return 0;
+
+    case INDICATOR_IOC_RMW:
+        batch = memdup_user((void __user *)arg, sizeof(*batch));
+        if (IS_ERR(batch))
+            return PTR_ERR(batch);
+
+        ret = region_rmw(led, batch);
+        if (!ret && copy_to_user((void __user *)arg, batch, sizeof(*batch)))
+            ret = -EFAULT;
+
+        kfree(batch);
+        return ret;
+
+    default:
+        return -ENOTTY;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+// Освободить учет отображений (последняя ссылка).
+static void region_mappings_release(struct kref * ref)
+{
+    kfree(container_of(ref, struct region_mappings, ref));
+}
+
+// Новое отображение окна регистров.
+static void indicator_vma_open(struct vm_area_struct * vma)
+{
+    struct region_mappings * maps = vma->vm_private_data;
+
+    kref_get(&maps->ref);
+    atomic_inc(&maps->count);
+}
+
+// Снятие отображения окна регистров (устройство может быть уже отвязано,
+// поэтому затрагивается только учет отображений).
+static void indicator_vma_close(struct vm_area_struct * vma)
+{
+    struct region_mappings * maps = vma->vm_private_data;
+
+    /* the shadow is dropped by the next access of the driver */
+    atomic_set(&maps->stale, 1);
+    atomic_dec(&maps->count);
+    kref_put(&maps->ref, region_mappings_release);
+}
+
+static const struct vm_operations_struct indicator_vm_ops =
+{
+    .open  = indicator_vma_open,
+    .close = indicator_vma_close,
+};
+
+//-----------------------------------------------------------------------------
+
+// Отобразить окно регистров IP-Core в пространство пользователя.
+static int indicator_mmap(struct file * filp, struct vm_area_struct * vma)
+{
+    struct indicator_file * file = filp->private_data;
+    struct ip_core * led   = file->led;
+    struct device  * dev   = led->device;
+    int ret;
+
+    /* 
+     * Only a page aligned window is mapped, whole pages around an 
+     * unaligned one would expose the registers of other peripherals.
+     */
+    if (!PAGE_ALIGNED(led->mem->start) || 
+        !PAGE_ALIGNED(resource_size(led->mem)))
+    {
+        dev_err(dev, "register window is not page aligned, can't map it\n");
+        return -ENODEV;
+    }
+
+    /* registers must not be cached or combined by the CPU */
+    vma->vm_page_prot = pgprot_noncached(vma->vm_page_prot);
+
+    ret = vm_iomap_memory(vma, led->mem->start, resource_size(led->mem));
+    if (ret < 0)
+    {
+        dev_err(dev, "can't map region to user space: %d\n", ret);
+        return ret;
+    }
+
+    /* .open isn't called for the initial mapping */
+    vma->vm_private_data = led->region.maps;
+    vma->vm_ops          = &indicator_vm_ops;
+    indicator_vma_open(vma);
+
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+// Структура файлового API символьного устройства.
+static const struct file_operations fops =
+{
+     .owner     = THIS_MODULE,
+     .open      = indicator_open,
+     .release   = indicator_release,
+     .llseek    = indicator_llseek,
+     .read_iter = indicator_read_iter,
+     .write_iter = indicator_write_iter,
+     .poll      = indicator_poll,
+     .mmap      = indicator_mmap,
+     .unlocked_ioctl = indicator_ioctl,
+     .fsync     = indicator_fsync
+};
+
+//-----------------------------------------------------------------------------
+//  Реализации функций SysFS.
+//-----------------------------------------------------------------------------
+
+// Аргументы функции чтения.
+#define SYSFS_ARGS_SHOW struct device * dev,                            \
+                        struct device_attribute * attr,                 \
+                        char * buf
+
+// Аргументы функции записи.
+#define SYSFS_ARGS_STORE struct device * dev,                           \
+                         struct device_attribute * attr,                \
+                         const char * buf, size_t count
 
 //-----------------------------------------------------------------------------
 
-// Применить параметр к машинному слову.
-static u32 apply_parameter(void __iomem * addr, u32 mask, u32 value)
+// Атрибут SysFS, созданный по описанию поля.
+struct indicator_field_attr
 {
-    u32 reg_read;
-
-    reg_read = ioread32(addr);
-    reg_read &= ~mask;                  /* reset to zero necessary bits */
-    value <<= get_mask_rank(mask);      /* shift value by mask */
-    reg_read |= value;                  /* set register with new value */
+    struct device_attribute attr;
+    const struct indicator_field * field;
+};
 
-    return reg_read;
-}
+#define to_field(_attr)                                                \
+    (container_of(_attr, struct indicator_field_attr, attr)->field)
 
 //-----------------------------------------------------------------------------
 
-// Определить выход значения за ограничение маски.
-static bool check_if_within_mask(u32 mask, u32 value)
+// Чтение поля.
+static ssize_t indicator_field_show(SYSFS_ARGS_SHOW)
 {
-    if (value > (mask >> get_mask_rank(mask)))
-    {
-        return false;
-    }
-    else 
-    {
-        return true;
-    }
+    return sysfs_read(dev, buf, to_field(attr));
 }
 
-//-----------------------------------------------------------------------------
-
-// Чтение для функций SysFS.
-static ssize_t sysfs_read(struct device * dev, char * buf,
-                        unsigned int addr_offset, u32 mask)
+// Запись поля.
+static ssize_t indicator_field_store(SYSFS_ARGS_STORE)
 {
-    u32 read_val, len;
-    char tmp[32];
-    void __iomem * addr;
-    struct ip_core * led = dev_get_drvdata(dev);
-    
-    addr = get_address(led, addr_offset);
-    read_val = ioread32(addr);
-    read_val &= mask;                       /* get only necessary bits */
-    read_val >>= get_mask_rank(mask);       /* make pretty print */
-    len =  snprintf(tmp, sizeof(tmp), "0x%x\n", read_val);
-    memcpy(buf, tmp, len);
-    
-    return len;
+    return sysfs_write(dev, buf, count, to_field(attr));
 }
 
 //-----------------------------------------------------------------------------
 
-// Запись для функций SysFS.
-static ssize_t sysfs_write(struct device * dev, const char * buf,
-                        size_t count, unsigned int addr_offset,
-                        u32 mask)
+// Чтение региона без разбора текста (окно в байтах, кратно регистру).
+static ssize_t region_bin_read(struct file * filp, struct kobject * kobj,
+                               struct bin_attribute * attr, char * buf,
+                               loff_t off, size_t count)
 {
-    struct ip_core * led   = dev_get_drvdata(dev);
-    void __iomem   * addr  = get_address(led, addr_offset);
-    unsigned long tmp;
-    u32 value;
+    struct device  * dev = kobj_to_dev(kobj);
+    struct ip_core * led = dev_get_drvdata(dev);
+    u32 reg[REGISTER_COUNT];
+    unsigned long which;
     int ret;
-    
-    ret = kstrtoul(buf, 0, &tmp);
-    if (ret < 0)
+
+    STAT_INC(led, sysfs);
+    ret = region_window(led, &off, &count, &which);
+    if (ret < 0 || !which)
         return ret;
-    
-    if (!check_if_within_mask(mask, (u32) tmp))
-    {
-        dev_warn(dev, "Invalid value {0x%lx} for address {0x%p}\n", 
-                tmp, addr);
-        return -EINVAL;
-    }
 
-    value = apply_parameter(addr, mask, (u32) tmp);
-    iowrite32(value, addr);
+    region_read(dev, reg, which);
+    memcpy(buf, (char *) reg + off, count);
 
     return count;
 }
 
-//-----------------------------------------------------------------------------
-//  Функции символьного устройства.
 //-----------------------------------------------------------------------------
 
-// Запрос контекста для символьного устройства.
-static int indicator_open(struct inode * inode, struct file * filp)
+// Запись региона без разбора текста.
+static ssize_t region_bin_write(struct file * filp, struct kobject * kobj,
+                                struct bin_attribute * attr, char * buf,
+                                loff_t off, size_t count)
 {
-    struct ip_core * led = (struct ip_core *)container_of(inode->i_cdev,
-                                                         struct ip_core,
-                                                         char_device);
-    filp->private_data = led;
-    
-    return 0;    
+    struct device  * dev = kobj_to_dev(kobj);
+    struct ip_core * led = dev_get_drvdata(dev);
+    u32 reg[REGISTER_COUNT];
+    unsigned long which;
+    int ret;
+
+    STAT_INC(led, sysfs);
+    ret = region_window(led, &off, &count, &which);
+    if (ret < 0 || !which)
+        return ret;
+
+    memcpy((char *) reg + off, buf, count);
+    region_commit(led, INDICATOR_SRC_SYSFS, reg, which);
+
+    return count;
 }
 
+static BIN_ATTR(region, 0644, region_bin_read, region_bin_write, REGION_SIZE);
+
 //-----------------------------------------------------------------------------
 
-// Освобождение контекста символьного устройства.
-static int indicator_release(struct inode * inode, struct file * filp)
+// Структура API каталога SysFS (заполняется из indicator_fields).
+static struct indicator_field_attr indicator_field_attrs[FIELD_COUNT];
+static struct attribute * indicator_attrs[FIELD_COUNT + 1];
+
+static struct bin_attribute * indicator_bin_attrs[] =
 {
-    filp->private_data = NULL;
-    
-    return 0;
-}
+    &bin_attr_region,
+    NULL
+};
+
+static const struct attribute_group indicator_attrs_group =
+{
+    .attrs     = indicator_attrs,
+    .bin_attrs = indicator_bin_attrs,
+};
 
 //-----------------------------------------------------------------------------
 
-// Чтение в символьное устройство.
-static ssize_t indicator_read(struct file * filp, char __user * buf,
-                    size_t count, loff_t * pos)
+// Создать атрибуты SysFS по таблице полей.
+static void build_field_attrs(void)
 {
-    struct ip_core * led   = (struct ip_core *)filp->private_data;
-    struct device  * dev   = led->device;
-    size_t region_size     = sizeof(led->region.reg);
-
-    if (count != region_size)
-    {
-        dev_err(dev, "incorrect read-value for region: %d "
-            "instead of %d\n", count, region_size);
-        return -EINVAL;
-    }        
-        
-    wake_up_interruptible(&indicator_read_wait);
+    struct indicator_field_attr * fattr;
+    const struct indicator_field * field;
+    u32 i;
 
-    mutex_lock(&led->region.access_mutex);
-    region_read(dev);
-    if (copy_to_user(buf, led->region.reg, region_size))
+    for (i = 0; i < FIELD_COUNT; i++)
     {
-        dev_err(dev, "can't copy local region to user\n");
-        mutex_unlock(&led->region.access_mutex);
-        return -EFAULT;
+        field = &indicator_fields[i];
+        fattr = &indicator_field_attrs[i];
+
+        sysfs_attr_init(&fattr->attr.attr);
+        fattr->field          = field;
+        fattr->attr.attr.name = field->name;
+        fattr->attr.attr.mode = field->mode;
+        fattr->attr.show      = (field->mode & 0444) ? indicator_field_show 
+                                                     : NULL;
+        fattr->attr.store     = (field->mode & 0222) ? indicator_field_store
+                                                     : NULL;
+
+        indicator_attrs[i] = &fattr->attr.attr;
     }
-    mutex_unlock(&led->region.access_mutex);
-    
-    return count;
+
+    indicator_attrs[FIELD_COUNT] = NULL;
 }
 
+//-----------------------------------------------------------------------------
+//  Статистика.
 //-----------------------------------------------------------------------------
 
-// Запись в символьное устройство.
-static ssize_t indicator_write(struct file * filp, const char __user * buf,
-                    size_t count, loff_t * pos)
+// Сумма счетчика по всем процессорам.
+static u64 stats_sum(struct ip_core * led, size_t offset)
 {
-    struct ip_core * led   = (struct ip_core *)filp->private_data;
-    struct device  * dev   = led->device;
-    size_t region_size     = sizeof(led->region.reg);
-    
-    if (count != region_size)
-    {
-        dev_err(dev, "incorrect write-value for region: %d "
-            "instead of %d\n", count, region_size);
-        return -EINVAL;
-    }        
-    
-    wake_up_interruptible(&indicator_write_wait);
+    u64 sum = 0;
+    int cpu;
+
+    for_each_possible_cpu(cpu)
+        sum += *(u64 *)((char *)per_cpu_ptr(led->stats, cpu) + offset);
+
+    return sum;
+}
+
+// Максимум счетчика по всем процессорам.
+static u64 stats_max(struct ip_core * led, size_t offset)
+{
+    u64 max = 0, value;
+    int cpu;
 
-    mutex_lock(&led->region.access_mutex);             
-    if (copy_from_user(led->region.reg, buf, region_size))
+    for_each_possible_cpu(cpu)
     {
-        dev_err(dev, "can't copy data from user to local region\n");
-        mutex_unlock(&led->region.access_mutex);
-        return -EFAULT;
+        value = *(u64 *)((char *)per_cpu_ptr(led->stats, cpu) + offset);
+        if (value > max)
+            max = value;
     }
-    region_write(dev);
-    mutex_unlock(&led->region.access_mutex);
-    
-    return count;  
+
+    return max;
 }
 
 //-----------------------------------------------------------------------------
 
-// Ожидание очереди символьным устройством.
-static unsigned int indicator_poll(struct file * filp,
-                            struct poll_table_struct * wait)
+// Атрибут счетчика (_fold - stats_sum или stats_max).
+#define STATS_ATTR(_field, _fold)                                      \
+    static ssize_t stats_##_field##_show(SYSFS_ARGS_SHOW)              \
+    {                                                                  \
+        struct ip_core * led = dev_get_drvdata(dev);                   \
+        return sprintf(buf, "%llu\n", _fold(led,                       \
+                       offsetof(struct indicator_stats, _field)));     \
+    }                                                                  \
+    static struct device_attribute dev_attr_stats_##_field =           \
+        __ATTR(_field, 0444, stats_##_field##_show, NULL)
+
+STATS_ATTR(reads,           stats_sum);
+STATS_ATTR(writes,          stats_sum);
+STATS_ATTR(sysfs,           stats_sum);
+STATS_ATTR(mmio_reads,      stats_sum);
+STATS_ATTR(mmio_writes,     stats_sum);
+STATS_ATTR(writes_skipped,  stats_sum);
+STATS_ATTR(einval,          stats_sum);
+STATS_ATTR(wait_ns,         stats_sum);
+STATS_ATTR(wait_max_ns,     stats_max);
+STATS_ATTR(hold_ns,         stats_sum);
+STATS_ATTR(hold_max_ns,     stats_max);
+
+//-----------------------------------------------------------------------------
+
+// Состояние замера ожидания и удержания access_lock.
+static ssize_t stats_timing_show(SYSFS_ARGS_SHOW)
 {
-    unsigned int mask = 0;
+    struct ip_core * led = dev_get_drvdata(dev);
 
-    poll_wait(filp, &indicator_read_wait, wait);
-    poll_wait(filp, &indicator_write_wait, wait);
-    
-    /* 
-     * It's always possible to read data from region, 
-     * because there are some information registers.
-     * 
-     * It's is also possible at any time to write to
-     * the region to configure the behavior of the 
-     * IP core.  
-     */
-    mask |= POLLIN | POLLRDNORM | POLLOUT | POLLWRNORM;
-    
-    return mask;
+    return sprintf(buf, "%d\n", READ_ONCE(led->timing));
+}
+
+// Включить или выключить замер (два чтения часов на каждый захват).
+static ssize_t stats_timing_store(SYSFS_ARGS_STORE)
+{
+    struct ip_core * led = dev_get_drvdata(dev);
+    bool on;
+    int ret;
+
+    ret = kstrtobool(buf, &on);
+    if (ret < 0)
+        return ret;
+
+    WRITE_ONCE(led->timing, on);
+
+    return count;
 }
 
+static struct device_attribute dev_attr_stats_timing =
+    __ATTR(timing, 0644, stats_timing_show, stats_timing_store);
+
 //-----------------------------------------------------------------------------
 
-// Структура файлового API символьного устройства.
-static const struct file_operations fops =
+// Структура API каталога статистики SysFS.
+static struct attribute * stats_attrs[] =
 {
-     .owner     = THIS_MODULE,
-     .open      = indicator_open,
-     .release   = indicator_release,
-     .read      = indicator_read,
-     .write     = indicator_write,
-     .poll      = indicator_poll     
+    &dev_attr_stats_reads.attr,
+    &dev_attr_stats_writes.attr,
+    &dev_attr_stats_sysfs.attr,
+    &dev_attr_stats_mmio_reads.attr,
+    &dev_attr_stats_mmio_writes.attr,
+    &dev_attr_stats_writes_skipped.attr,
+    &dev_attr_stats_einval.attr,
+    &dev_attr_stats_wait_ns.attr,
+    &dev_attr_stats_wait_max_ns.attr,
+    &dev_attr_stats_hold_ns.attr,
+    &dev_attr_stats_hold_max_ns.attr,
+    &dev_attr_stats_timing.attr,
+    NULL
+};
+
+static const struct attribute_group stats_attrs_group =
+{
+    .name  = "stats",
+    .attrs = stats_attrs,
 };
 
 //-----------------------------------------------------------------------------
-//  Реализации функций SysFS.
+//  История изменений (debugfs).
 //-----------------------------------------------------------------------------
 
-// Аргументы функции чтения.
-#define SYSFS_ARGS_SHOW struct device * dev,                            \
-                        struct device_attribute * attr,                 \
-                        char * buf
-
-// Аргументы функции записи.
-#define SYSFS_ARGS_STORE struct device * dev,                           \
-                         struct device_attribute * attr,                \
-                         const char * buf, size_t count
+// Чтение истории (копия кольца целиком).
+static ssize_t history_read(struct file * filp, char __user * buf,
+                            size_t count, loff_t * pos)
+{
+    struct dentry  * dentry = file_dentry(filp);
+    struct ip_core * led    = filp->private_data;
+    ssize_t ret;
 
-//-----------------------------------------------------------------------------
+    /* the file isn't proxied, the device may be gone */
+    ret = debugfs_file_get(dentry);
+    if (ret)
+        return ret;
 
-// Сигнатура функции чтения.
-#define SYSFS_SHOW(_func_name_)                                        \
-    static ssize_t indicator_##_func_name_##_show(SYSFS_ARGS_SHOW)
+    ret = simple_read_from_buffer(buf, count, pos, led->history,
+                                  sizeof(struct indicator_history));
+    debugfs_file_put(dentry);
 
-// Сигнатура функции записи.
-#define SYSFS_STORE(_func_name_)                                       \
-    static ssize_t indicator_##_func_name_##_store(SYSFS_ARGS_STORE)
+    return ret;
+}
 
 //-----------------------------------------------------------------------------
 
-// Задать атрибуты функции для чтения/записи.
-#define INDICATOR_DEVICE_ATTR_RW(_name)                                        \
-    DEVICE_ATTR_RW(indicator_##_name)
+// Отобразить кольцо истории в пространство пользователя (только чтение).
+static int history_mmap(struct file * filp, struct vm_area_struct * vma)
+{
+    struct dentry  * dentry = file_dentry(filp);
+    struct ip_core * led    = filp->private_data;
+    int ret;
 
-// Задать атрибуты функции только для чтения.
-#define INDICATOR_DEVICE_ATTR_RO(_name)                                        \
-    DEVICE_ATTR_RO(indicator_##_name)
+    /* the ring belongs to the writers */
+    if (vma->vm_flags & VM_WRITE)
+        return -EPERM;
 
-//-----------------------------------------------------------------------------
+    vma->vm_flags &= ~VM_MAYWRITE;
 
-/* indicator-led main file */
-SYSFS_SHOW(indicator_led)
-{
-    u32 mask = 0xFFU;     /* 7-0 bits */
-    return sysfs_read(dev, buf, INDICATOR_OFFSET,
-                    mask);
-}
+    /* the ring goes with the device, mapped pages keep their own refs */
+    ret = debugfs_file_get(dentry);
+    if (ret)
+        return ret;
 
-SYSFS_STORE(indicator_led)
-{
-    u32 mask = 0xFFU;     /* 7-0 bits */
-    return sysfs_write(dev, buf, count, 
-                    INDICATOR_OFFSET,
-                    mask);
+    ret = remap_vmalloc_range(vma, led->history, vma->vm_pgoff);
+    debugfs_file_put(dentry);
+
+    return ret;
 }
- 
-static INDICATOR_DEVICE_ATTR_RW(indicator_led);
 
 //-----------------------------------------------------------------------------
 
-// Структура API каталога SysFS.
-static struct attribute * indicator_attrs[] =
+// Структура файлового API истории.
+static const struct file_operations history_fops =
 {
-    &dev_attr_indicator_indicator_led.attr,            
-    NULL
+     .owner     = THIS_MODULE,
+     .open      = simple_open,
+     .read      = history_read,
+     .mmap      = history_mmap,
+     .llseek    = default_llseek
 };
 
-static const struct attribute_group indicator_attrs_group =
+//-----------------------------------------------------------------------------
+
+// Освободить кольцо истории (действие devres).
+static void history_free(void * data)
 {
-    .attrs = indicator_attrs,
-};
+    vfree(data);
+}
+
+// Отпустить ссылку устройства на учет отображений (действие devres).
+static void region_mappings_free(void * data)
+{
+    struct region_mappings * maps = data;
+
+    kref_put(&maps->ref, region_mappings_release);
+}
 
 //-----------------------------------------------------------------------------
 // Для деинициализации драйвера.
@@ -396,10 +1802,15 @@ static const struct attribute_group indicator_attrs_group =
 // Этапы деинициализации.
 enum ip_core_clean 
 {
+    IP_CORE_CLEAN_DEBUGFS,
+    IP_CORE_CLEAN_LEDS,
+    IP_CORE_CLEAN_STATS,
     IP_CORE_CLEAN_GROUP,
     IP_CORE_DELETE_DEVICE,
+    IP_CORE_STOP_PATTERN,
+    IP_CORE_DESTROY_WQ,
     IP_CORE_DESTROY_DEVICE,
-    IP_CORE_UNREGISTER_REGION,
+    IP_CORE_FREE_MINOR,
     IP_CORE_CLEAN_INITIAL    
 };
 
@@ -410,11 +1821,28 @@ void cleanup_handler(struct platform_device * pdev, enum ip_core_clean index)
 {
     struct device  * dev     = &pdev->dev;
     struct ip_core * ipcore  = dev_get_drvdata(dev);
+    unsigned long flags;
     
     dev_dbg(dev, "cleanup handler function called\n");
     
     switch (index)
     {
+    case IP_CORE_CLEAN_DEBUGFS:
+        /* mappings keep their pages, the ring itself is freed by devres */
+        debugfs_remove_recursive(ipcore->debugfs);
+        /* fall through */
+
+    case IP_CORE_CLEAN_LEDS:
+        /* triggers must not change the region past this point */
+        while (ipcore->led_count)
+            devm_led_classdev_unregister(dev, 
+                                &ipcore->leds[--ipcore->led_count].cdev);
+        /* fall through */
+
+    case IP_CORE_CLEAN_STATS:
+        sysfs_remove_group(&ipcore->device->kobj, &stats_attrs_group);
+        /* fall through */
+
     case IP_CORE_CLEAN_GROUP:
         sysfs_remove_group(&ipcore->device->kobj, &indicator_attrs_group);
         /* fall through */
@@ -423,12 +1851,33 @@ void cleanup_handler(struct platform_device * pdev, enum ip_core_clean index)
         cdev_del(&ipcore->char_device);
         /* fall through */
 
+    case IP_CORE_STOP_PATTERN:
+        /* patterns are started through the char device only */
+        spin_lock_irqsave(&ipcore->pattern.lock, flags);
+        ipcore->pattern.removed = true;
+        spin_unlock_irqrestore(&ipcore->pattern.lock, flags);
+        pattern_stop(ipcore);
+        /* fall through */
+
+    case IP_CORE_DESTROY_WQ:
+        spin_lock_irqsave(&ipcore->commit.lock, flags);
+        ipcore->commit.dead = true;
+        spin_unlock_irqrestore(&ipcore->commit.lock, flags);
+        /* commits the last posted value while the device still exists */
+        destroy_workqueue(ipcore->commit.wq);
+        /* 
+         * Every region_changed() source is stopped by now, so the 
+         * pending notification of the device can't be queued again.
+         */
+        cancel_work_sync(&ipcore->notify);
+        /* fall through */
+
     case IP_CORE_DESTROY_DEVICE:
         device_destroy(ipcore_driver_class, ipcore->devt);
         /* fall through */
 
-    case IP_CORE_UNREGISTER_REGION:
-        unregister_chrdev_region(ipcore->devt, 1);
+    case IP_CORE_FREE_MINOR:
+        ida_free(&ipcore_minors, MINOR(ipcore->devt));
         /* fall through */
 
     case IP_CORE_CLEAN_INITIAL:
@@ -451,22 +1900,70 @@ static int ip_core_probe(struct platform_device * pdev)
     struct resource * r_mem  = NULL;         /* IO mem resources */
     struct ip_core * ipcore  = NULL;         /* represents IP Core */
     struct device * dev      = &pdev->dev;   /* OS device (from device tree) */
-    char * device_name       = NULL;         /* unique name of the device */
-    char * tmp_device_name   = NULL;
+    u32 reg[REGISTER_COUNT];                /* initial values of the region */
+    struct dentry * history  = NULL;         /* debugfs file of the history */
     size_t i;
         
     dev_dbg(dev, "probe function called\n");
     
-    /* allocate device wrapper memory */
-    ipcore = devm_kmalloc(dev, sizeof (*ipcore), GFP_KERNEL);
-    if (IS_ERR(ipcore))
+    /* allocate device wrapper memory, zeroed for the embedded LED class */
+    ipcore = devm_kzalloc(dev, sizeof (*ipcore), GFP_KERNEL);
+    if (!ipcore)
     {
         dev_err(dev, "can't allocate memmory for device");
-        return PTR_ERR(ipcore);
+        return -ENOMEM;
     }
 
     dev_set_drvdata(dev, ipcore);
     ipcore->dt_device = dev;
+
+    /* per-CPU counters, so the hot paths don't share a cache line */
+    ipcore->timing = true;      /* stats/timing turns the clock reads off */
+    ipcore->stats  = devm_alloc_percpu(dev, struct indicator_stats);
+    if (!ipcore->stats)
+    {
+        dev_err(dev, "can't allocate statistics\n");
+        cleanup_handler(pdev, IP_CORE_CLEAN_INITIAL);
+        return -ENOMEM;
+    }
+
+    /* history ring, recorded at every commit and mapped by readers */
+    ipcore->history = vmalloc_user(HISTORY_SIZE);
+    if (!ipcore->history)
+    {
+        dev_err(dev, "can't allocate history\n");
+        cleanup_handler(pdev, IP_CORE_CLEAN_INITIAL);
+        return -ENOMEM;
+    }
+
+    ret = devm_add_action_or_reset(dev, history_free, ipcore->history);
+    if (ret < 0)
+    {
+        cleanup_handler(pdev, IP_CORE_CLEAN_INITIAL);
+        return ret;
+    }
+
+    /* mapping accounting, outlives the device while it is mapped */
+    ipcore->region.maps = kzalloc(sizeof(*ipcore->region.maps), GFP_KERNEL);
+    if (!ipcore->region.maps)
+    {
+        dev_err(dev, "can't allocate mapping accounting\n");
+        cleanup_handler(pdev, IP_CORE_CLEAN_INITIAL);
+        return -ENOMEM;
+    }
+
+    kref_init(&ipcore->region.maps->ref);
+    ret = devm_add_action_or_reset(dev, region_mappings_free, 
+                                   ipcore->region.maps);
+    if (ret < 0)
+    {
+        cleanup_handler(pdev, IP_CORE_CLEAN_INITIAL);
+        return ret;
+    }
+
+    ipcore->history->entries    = INDICATOR_HISTORY_ENTRIES;
+    ipcore->history->entry_size = sizeof(struct indicator_history_entry);
+    atomic_set(&ipcore->history_seq, 0);
             
     //-------------------------------------------------------------------------
     //   init device memory space
@@ -496,61 +1993,101 @@ static int ip_core_probe(struct platform_device * pdev)
             &ipcore->mem->end);
     dev_info(dev, "remapped memory to 0x%p\n", ipcore->io_base);
     
-    /* init mutex */
-    mutex_init(&ipcore->region.access_mutex);
+    /* init writer lock and reader sequence */
+    spin_lock_init(&ipcore->region.access_lock);
+    seqcount_init(&ipcore->region.seq);
+
+    /* init change notification */
+    init_waitqueue_head(&ipcore->change_wait);
+    atomic_set(&ipcore->change_seq, 0);
+    INIT_WORK(&ipcore->notify, region_notify);
+
+    /* init pattern engine */
+    spin_lock_init(&ipcore->pattern.lock);
+    ipcore->pattern.active  = false;
+    ipcore->pattern.removed = false;
+    hrtimer_init(&ipcore->pattern.timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+    ipcore->pattern.timer.function = pattern_step;
     
+    /* flat register lists for the read and write paths */
+    build_access_plans(ipcore);
+
+    /* init shadow from the readable registers, write-only stay unknown */
+    ipcore->region.shadow_valid = 0;
+    for (i = 0; i < REGISTER_COUNT; i++)
+    {
+        if (indicator_regs[i].access & REG_ACCESS_READ)
+        {
+            ipcore->region.shadow[i] = ioread32(get_address(ipcore, 
+                                                indicator_regs[i].offset));
+            set_bit(i, &ipcore->region.shadow_valid);
+        }
+        else
+        {
+            ipcore->region.shadow[i] = 0;
+        }
+    }
+
     /* print the initial values of the region  */
-    region_read(dev);
-    /* don't need lock mutex, because make debug-print in init function */
+    region_read(dev, reg, REGION_ALL);
     for (i = 0; i < REGISTER_COUNT; i++)
     {
-        dev_dbg(dev, "region reg%d = %x\n", i, ipcore->region.reg[i]);
+        dev_dbg(dev, "region reg%d = %x\n", i, reg[i]);
     }
     
     //-------------------------------------------------------------------------
     //   init char device
     //-------------------------------------------------------------------------
     
-    /* create unique device name  */
-    device_name = devm_kmalloc(dev, DRIVER_NAME_LEN, GFP_KERNEL);
-    tmp_device_name = devm_kmalloc(dev, DRIVER_NAME_LEN, GFP_KERNEL);
-    snprintf(tmp_device_name, DRIVER_NAME_LEN, "%pad", &ipcore->mem->start);
-    snprintf(device_name, DRIVER_NAME_LEN, "%s_%s", DRIVER_NAME, 
-            &tmp_device_name[2]);
-    
-    /* allocate device number */
-    ret = alloc_chrdev_region(&ipcore->devt, 0, 1, device_name);
+    /* take a minor of the major reserved at module init */
+    ret = ida_alloc_max(&ipcore_minors, DRIVER_MINORS - 1, GFP_KERNEL);
     if (ret < 0)
     {
-        dev_err(dev, "can't allocate chrdev region\n");
+        dev_err(dev, "can't allocate device minor\n");
         cleanup_handler(pdev, IP_CORE_CLEAN_INITIAL);
         return ret;
     }
     else
     {
+        ipcore->devt = MKDEV(MAJOR(ipcore_devt), MINOR(ipcore_devt) + ret);
         dev_dbg(dev, "allocated device number major %i minor %i\n",
             MAJOR(ipcore->devt), MINOR(ipcore->devt));
     }
     
     /* create driver file */
     ipcore->device = device_create(ipcore_driver_class, NULL, ipcore->devt,
-                                NULL, device_name);
+                                NULL, DEVICE_NAME_FMT, 
+                                DEVICE_NAME_ARGS(ipcore->mem));
     if (IS_ERR(ipcore->device))
     {
-        dev_err(dev, "can't create driver file -> %s\n", device_name);
-        cleanup_handler(pdev, IP_CORE_UNREGISTER_REGION);
+        dev_err(dev, "can't create driver file\n");
+        cleanup_handler(pdev, IP_CORE_FREE_MINOR);
         return PTR_ERR(ipcore->device);
     }
 
     dev_set_drvdata(ipcore->device, ipcore);
     
+    /* init deferred commit of O_NONBLOCK writes, the work uses the device */
+    spin_lock_init(&ipcore->commit.lock);
+    ipcore->commit.pending = 0;
+    ipcore->commit.dead    = false;
+    INIT_WORK(&ipcore->commit.work, commit_work);
+    ipcore->commit.wq = alloc_ordered_workqueue(DEVICE_NAME_FMT, WQ_HIGHPRI,
+                                                DEVICE_NAME_ARGS(ipcore->mem));
+    if (!ipcore->commit.wq)
+    {
+        dev_err(dev, "can't allocate commit workqueue\n");
+        cleanup_handler(pdev, IP_CORE_DESTROY_DEVICE);
+        return -ENOMEM;
+    }
+    
     /* create character device */
     cdev_init(&ipcore->char_device, &fops);
     ret = cdev_add(&ipcore->char_device, ipcore->devt, 1);
     if (ret < 0)
     {
         dev_err(dev, "can't create character device\n");
-        cleanup_handler(pdev, IP_CORE_DESTROY_DEVICE);
+        cleanup_handler(pdev, IP_CORE_DESTROY_WQ);
         return ret;
     }
 
@@ -565,6 +2102,38 @@ static int ip_core_probe(struct platform_device * pdev)
         cleanup_handler(pdev, IP_CORE_DELETE_DEVICE);
         return ret;                                                    
     }
+
+    ret = sysfs_create_group(&ipcore->device->kobj, &stats_attrs_group);
+    if (ret < 0)
+    {
+        dev_err(dev, "can't register sysfs statistics group\n");
+        cleanup_handler(pdev, IP_CORE_CLEAN_GROUP);
+        return ret;
+    }
+
+    //-------------------------------------------------------------------------
+    // register LED class devices
+    //-------------------------------------------------------------------------
+
+    ret = indicator_leds_register(ipcore);
+    if (ret < 0)
+    {
+        dev_err(dev, "can't register LED class devices\n");
+        cleanup_handler(pdev, IP_CORE_CLEAN_LEDS);
+        return ret;
+    }
+
+    /* debugfs is optional, its failures are not checked by design */
+    ipcore->debugfs = debugfs_create_dir(dev_name(ipcore->device),
+                                         ipcore_debugfs);
+    /* 
+     * The full proxy of debugfs doesn't forward .mmap, so the file is 
+     * created unsafe and its operations guard against removal themselves.
+     */
+    history = debugfs_create_file_unsafe("history", 0444, ipcore->debugfs,
+                                         ipcore, &history_fops);
+    if (!IS_ERR_OR_NULL(history))
+        d_inode(history)->i_size = HISTORY_SIZE;
     
     return 0;
 }
@@ -575,7 +2144,7 @@ static int ip_core_probe(struct platform_device * pdev)
 static int ip_core_remove(struct platform_device * pdev)
 {
     dev_dbg(&pdev->dev, "remove function called\n");
-    cleanup_handler(pdev, IP_CORE_CLEAN_GROUP);    
+    cleanup_handler(pdev, IP_CORE_CLEAN_DEBUGFS);    
     
     return 0;
 }
@@ -599,6 +2168,8 @@ static struct platform_driver ip_core_driver =
     {
         .name           = DRIVER_NAME,
         .of_match_table = ip_core_of_match,        
+        /* IP cores don't depend on each other, probe them in parallel */
+        .probe_type     = PROBE_PREFER_ASYNCHRONOUS,
     },
     .probe  = ip_core_probe,
     .remove = ip_core_remove,    
@@ -609,17 +2180,44 @@ static struct platform_driver ip_core_driver =
 // Инициализация модуля.
 static int __init indicator_init(void)
 {    
+    int ret;
+
     pr_info("%s loaded\n", DRIVER_NAME);
     
+    /* sysfs attributes are shared by all devices */
+    build_field_attrs();
+
+    /* per-device history directories are created on probe */
+    ipcore_debugfs = debugfs_create_dir(DRIVER_NAME, NULL);
+
+    /* one major for all devices, minors are handed out on probe */
+    ret = alloc_chrdev_region(&ipcore_devt, 0, DRIVER_MINORS, DRIVER_NAME);
+    if (ret < 0)
+    {
+        printk(KERN_ERR "Can't allocate chrdev region \"%s\"\n", DRIVER_NAME);
+        debugfs_remove_recursive(ipcore_debugfs);
+        return ret;
+    }
+
     /* create class for char device */
     ipcore_driver_class = class_create(THIS_MODULE, DRIVER_NAME);
     if (IS_ERR(ipcore_driver_class))
     {
         printk(KERN_ERR "Can't create char device class \"%s\"\n", DRIVER_NAME);
+        unregister_chrdev_region(ipcore_devt, DRIVER_MINORS);
+        debugfs_remove_recursive(ipcore_debugfs);
         return PTR_ERR(ipcore_driver_class);
     }
     
-    return platform_driver_register(&ip_core_driver);   
+    ret = platform_driver_register(&ip_core_driver);
+    if (ret < 0)
+    {
+        class_destroy(ipcore_driver_class);
+        unregister_chrdev_region(ipcore_devt, DRIVER_MINORS);
+        debugfs_remove_recursive(ipcore_debugfs);
+    }
+
+    return ret;
 }
 
 //-----------------------------------------------------------------------------
@@ -629,6 +2227,8 @@ static void __exit indicator_exit(void)
 {
     platform_driver_unregister(&ip_core_driver);
     class_destroy(ipcore_driver_class);
+    unregister_chrdev_region(ipcore_devt, DRIVER_MINORS);
+    debugfs_remove_recursive(ipcore_debugfs);
     pr_info("%s unloaded\n", DRIVER_NAME);
 }
 
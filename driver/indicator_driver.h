@@ -1,18 +1,122 @@
 #ifndef INDICATOR_DRIVER_H
 #define INDICATOR_DRIVER_H
 
+#include <linux/types.h>
+#include <linux/ioctl.h>
+
 #define BASE_ADDR 0x40000000U
 #define INDICATOR_OFFSET 0x00U
-#define BITMASK_REGISTERS 0x3    /* bitmask of available registers */
 #define REGISTER_COUNT 1
 #define DRIVER_NAME "indicator_driver"
-#define DRIVER_NAME_LEN 128
+#define DRIVER_MINORS 256
 
+#ifndef __cplusplus
 #ifndef false
 #define false 0
 #endif
 #ifndef true
 #define true 1
 #endif
+#endif
+
+//-----------------------------------------------------------------------------
+//  ioctl interface of the char device.
+//-----------------------------------------------------------------------------
+
+#define INDICATOR_IOC_MAGIC     'i'
+#define INDICATOR_PATTERN_MAX   32      /* max steps in one pattern */
+#define INDICATOR_RMW_MAX       16      /* max operations in one batch */
+
+/* one step of a pattern: color to latch and how long to hold it */
+struct indicator_step
+{
+    __u32 color;            /* value of the indicator_led field */
+    __u32 duration_ms;      /* hold time, at least 1 ms */
+};
+
+/* 
+ * pattern played by the in-driver hrtimer, any other write of the region
+ * (char device, sysfs, ioctl, LED class) stops it, stores through mmap() 
+ * aren't seen by the driver and are overwritten by the next step
+ */
+struct indicator_pattern
+{
+    __u32 count;            /* number of used steps */
+    __u32 repeat;           /* rounds to play, 0 - play forever */
+    struct indicator_step steps[INDICATOR_PATTERN_MAX];
+};
+
+/* 
+ * read-modify-write of one register: reg = (reg & ~mask) | (value & mask),
+ * value is already shifted to the mask position, mask 0 only reads
+ */
+struct indicator_rmw_op
+{
+    __u32 offset;           /* register offset in bytes */
+    __u32 mask;             /* bits to replace */
+    __u32 value;            /* new value of the masked bits */
+    __u32 old;              /* register value before the operation (out) */
+};
+
+/* batch applied under one lock hold */
+struct indicator_rmw_batch
+{
+    __u32 count;            /* number of used operations */
+    struct indicator_rmw_op ops[INDICATOR_RMW_MAX];
+};
+
+#define INDICATOR_IOC_SET_PATTERN                                      \
+    _IOW(INDICATOR_IOC_MAGIC, 0x01, struct indicator_pattern)
+#define INDICATOR_IOC_STOP_PATTERN                                     \
+    _IO(INDICATOR_IOC_MAGIC, 0x02)
+#define INDICATOR_IOC_RMW                                              \
+    _IOWR(INDICATOR_IOC_MAGIC, 0x03, struct indicator_rmw_batch)
+
+//-----------------------------------------------------------------------------
+//  History of region changes (debugfs: indicator_driver/<device>/history).
+//-----------------------------------------------------------------------------
+
+#define INDICATOR_HISTORY_ENTRIES   1024    /* power of two */
+
+/* who changed the region */
+enum indicator_source
+{
+    INDICATOR_SRC_CHARDEV,  /* write(), pwrite(), writev() */
+    INDICATOR_SRC_COMMIT,   /* O_NONBLOCK write, committed later */
+    INDICATOR_SRC_IOCTL,    /* INDICATOR_IOC_RMW */
+    INDICATOR_SRC_SYSFS,    /* text or binary attribute */
+    INDICATOR_SRC_LED,      /* LED class device or trigger */
+    INDICATOR_SRC_PATTERN   /* pattern engine */
+};
+
+#define INDICATOR_HISTORY_OLD_VALID 0x01    /* old holds the latched value */
+
+/* 
+ * one committed register change; seq is 0 while the entry is being 
+ * rewritten, a reader copies the entry and checks seq didn't change
+ */
+struct indicator_history_entry
+{
+    __u32 seq;              /* number of the change, starting from 1 */
+    __s32 pid;              /* writer's process, 0 in interrupt context */
+    __u64 time_ns;          /* ktime_get_ns() */
+    __u8  source;           /* enum indicator_source */
+    __u8  flags;            /* INDICATOR_HISTORY_* */
+    __u16 offset;           /* register offset in bytes */
+    __u32 old;              /* value before the change */
+    __u32 value;            /* value written */
+    __u32 reserved;
+};
+
+/* layout of the history file, read or mapped read-only */
+struct indicator_history
+{
+    __u32 head;             /* seq of the newest entry */
+    __u32 entries;          /* INDICATOR_HISTORY_ENTRIES */
+    __u32 entry_size;       /* sizeof(struct indicator_history_entry) */
+    __u32 reserved[5];
+    /* entry with seq n lives at ring[(n - 1) % entries] */
+    struct indicator_history_entry ring[INDICATOR_HISTORY_ENTRIES];
+};
 
 #endif /* INDICATOR_DRIVER_H */
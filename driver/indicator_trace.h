@@ -0,0 +1,67 @@
+/*
+ * Xilinx Led-indicator driver tracepoints
+ *
+ * Copyright (C) 2021 Kirill Yustitskii
+ */
+
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM indicator
+
+#if !defined(INDICATOR_TRACE_H) || defined(TRACE_HEADER_MULTI_READ)
+#define INDICATOR_TRACE_H
+
+#include <linux/device.h>
+#include <linux/tracepoint.h>
+
+//-----------------------------------------------------------------------------
+
+// Обращение к регистру IP-Core.
+DECLARE_EVENT_CLASS(indicator_access,
+
+    TP_PROTO(struct device * dev, u32 offset, u32 value,
+             u64 wait_ns, u64 mmio_ns),
+
+    TP_ARGS(dev, offset, value, wait_ns, mmio_ns),
+
+    TP_STRUCT__entry(
+        __string(dev,       dev_name(dev))
+        __field(u32,        offset)         /* register offset */
+        __field(u32,        value)          /* value read or written */
+        __field(u64,        wait_ns)        /* waiting for access_lock */
+        __field(u64,        mmio_ns)        /* spent on the bus access */
+    ),
+
+    TP_fast_assign(
+        __assign_str(dev, dev_name(dev));
+        __entry->offset  = offset;
+        __entry->value   = value;
+        __entry->wait_ns = wait_ns;
+        __entry->mmio_ns = mmio_ns;
+    ),
+
+    TP_printk("%s offset=0x%02x value=0x%08x wait=%lluns mmio=%lluns",
+              __get_str(dev), __entry->offset, __entry->value,
+              __entry->wait_ns, __entry->mmio_ns)
+);
+
+//-----------------------------------------------------------------------------
+
+#define INDICATOR_ACCESS_EVENT(_name)                                  \
+    DEFINE_EVENT(indicator_access, _name,                              \
+        TP_PROTO(struct device * dev, u32 offset, u32 value,           \
+                 u64 wait_ns, u64 mmio_ns),                            \
+        TP_ARGS(dev, offset, value, wait_ns, mmio_ns))
+
+INDICATOR_ACCESS_EVENT(indicator_region_read);
+INDICATOR_ACCESS_EVENT(indicator_region_write);
+INDICATOR_ACCESS_EVENT(indicator_sysfs_read);
+INDICATOR_ACCESS_EVENT(indicator_sysfs_write);
+
+#endif /* INDICATOR_TRACE_H */
+
+/* this part must be outside the header guard */
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH .
+#undef TRACE_INCLUDE_FILE
+#define TRACE_INCLUDE_FILE indicator_trace
+#include <trace/define_trace.h>
@@ -0,0 +1,317 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+
+#include "cindicator.h"
+#include "cindicatormap.h"
+#include "cdevsim.h"
+#include "device-library/cdevsym.h"
+#include "driver/indicator_driver.h"
+
+// Замер стоимости смены цвета по всем путям доступа драйвера.
+// Результат выводится в CSV (одна строка на путь и число потоков).
+
+//=============================================================================
+
+// Параметры запуска.
+struct SOptions
+{
+    std::string device  = "indicator_driver_40000000";
+    size_t      threads = 4;
+    size_t      iters   = 100000;
+    bool        sim     = false;
+};
+
+// Одна операция: номер итерации -> успех.
+using op_t = std::function<bool(size_t)>;
+
+// Путь доступа: создает операцию для потока (nullptr - путь недоступен).
+struct SCase
+{
+    std::string path;
+    std::string op;
+    std::function<op_t()> make;
+};
+
+//=============================================================================
+
+// Цвет итерации (чередуется, чтобы драйвер не пропускал запись).
+static uint32_t colorOf(size_t i)
+{
+    return (i & 1) ? static_cast<uint32_t>(drv::IIndicator::color_t::RED)
+                   : static_cast<uint32_t>(drv::IIndicator::color_t::GREEN);
+}
+
+//-----------------------------------------------------------------------------
+
+// Открыть файл, закрываемый вместе с операцией.
+static std::shared_ptr<int> openFd(const std::string & path, int flags)
+{
+    int fd = ::open(path.c_str(), flags);
+    if (fd < 0)
+        return nullptr;
+
+    return std::shared_ptr<int>(new int(fd), [](int * p) { ::close(*p); delete p; });
+}
+
+//=============================================================================
+
+// Пути доступа к реальному устройству.
+static std::vector<SCase> deviceCases(const SOptions & opt)
+{
+    auto devPath   = "/dev/" + opt.device;
+    auto sysfsPath = "/sys/class/" DRIVER_NAME "/" + opt.device + "/indicator_indicator_led";
+    std::vector<SCase> cases;
+
+    cases.push_back({"sysfs", "write", [sysfsPath]() -> op_t {
+        auto fd = openFd(sysfsPath, O_WRONLY);
+        if (!fd) return nullptr;
+        return [fd](size_t i) {
+            char buf[16];
+            int len = snprintf(buf, sizeof(buf), "0x%x", colorOf(i));
+            return ::pwrite(*fd, buf, len, 0) == len;
+        };
+    }});
+
+    cases.push_back({"sysfs", "read", [sysfsPath]() -> op_t {
+        auto fd = openFd(sysfsPath, O_RDONLY);
+        if (!fd) return nullptr;
+        return [fd](size_t) {
+            char buf[16];
+            return ::pread(*fd, buf, sizeof(buf), 0) > 0;
+        };
+    }});
+
+    cases.push_back({"chardev", "write", [devPath]() -> op_t {
+        auto fd = openFd(devPath, O_RDWR);
+        if (!fd) return nullptr;
+        return [fd](size_t i) {
+            uint32_t reg[REGISTER_COUNT] = {colorOf(i)};
+            return ::write(*fd, reg, sizeof(reg)) == sizeof(reg);
+        };
+    }});
+
+    cases.push_back({"chardev", "read", [devPath]() -> op_t {
+        auto fd = openFd(devPath, O_RDWR);
+        if (!fd) return nullptr;
+        return [fd](size_t) {
+            uint32_t reg[REGISTER_COUNT];
+            return ::read(*fd, reg, sizeof(reg)) == sizeof(reg);
+        };
+    }});
+
+    cases.push_back({"batched", "rmw", [devPath]() -> op_t {
+        auto fd = openFd(devPath, O_RDWR);
+        if (!fd) return nullptr;
+        return [fd](size_t i) {
+            indicator_rmw_batch batch{};
+            batch.count         = 1;
+            batch.ops[0].offset = INDICATOR_OFFSET;
+            batch.ops[0].mask   = 0xFFU;
+            batch.ops[0].value  = colorOf(i);
+            return ::ioctl(*fd, INDICATOR_IOC_RMW, &batch) == 0;
+        };
+    }});
+
+    cases.push_back({"mapped", "store", [devPath]() -> op_t {
+        auto ind = std::make_shared<drv::CIndicatorMap>();
+        if (!ind->mapOpen(devPath)) return nullptr;
+        return [ind](size_t i) {
+            ind->setColor(static_cast<drv::IIndicator::color_t>(colorOf(i)));
+            return true;
+        };
+    }});
+
+    // CIndicator over CDevSym, one instance per thread like separate clients.
+    auto api = [devPath](bool send) -> std::function<op_t()> {
+        return [devPath, send]() -> op_t {
+            auto ind = std::make_shared<drv::CIndicator>();
+            auto dev = std::shared_ptr<dev::sym::CDevSym>(new dev::sym::CDevSym(),
+                [](dev::sym::CDevSym * p) { p->devClose(); delete p; });
+
+            dev->setDevPath(devPath);
+            dev->setMaxSize(ind->region().getSize());
+            if (!dev->devOpen()) return nullptr;
+
+            dev->setMemIO(ind->region().getIntMemIO());
+            ind->region().setDevIO(dev->getIntDevIO());
+
+            if (send)
+                return [ind, dev](size_t i) {
+                    ind->setColor(static_cast<drv::IIndicator::color_t>(colorOf(i)));
+                    return ind->region().send();
+                };
+            return [ind, dev](size_t) { return ind->region().recv(); };
+        };
+    };
+
+    cases.push_back({"api", "send", api(true)});
+    cases.push_back({"api", "recv", api(false)});
+
+    return cases;
+}
+
+//-----------------------------------------------------------------------------
+
+// Путь через имитацию IP-Core (общая для всех потоков).
+static std::vector<SCase> simCases()
+{
+    auto sim  = std::make_shared<dev::sim::CDevSim>();
+    auto ind  = std::make_shared<drv::CIndicator>();
+    auto lock = std::make_shared<std::mutex>();
+
+    sim->setMemIO(ind->region().getIntMemIO());
+    ind->region().setDevIO(sim->getIntDevIO());
+
+    // The threads share one local region, so a color change and its
+    // transfer must not interleave with another thread's.
+    return {
+        {"sim", "send", [sim, ind, lock]() -> op_t {
+            return [sim, ind, lock](size_t i) {
+                std::lock_guard<std::mutex> guard(*lock);
+                ind->setColor(static_cast<drv::IIndicator::color_t>(colorOf(i)));
+                return ind->region().send();
+            };
+        }},
+        {"sim", "recv", [sim, ind, lock]() -> op_t {
+            return [sim, ind, lock](size_t) {
+                std::lock_guard<std::mutex> guard(*lock);
+                return ind->region().recv();
+            };
+        }}
+    };
+}
+
+//=============================================================================
+
+// Прогнать путь в заданном числе потоков и вывести строку CSV.
+static void run(const SCase & test, size_t threads, size_t iters)
+{
+    std::vector<op_t> ops;
+    for (size_t t = 0; t < threads; t++)
+    {
+        auto op = test.make();
+        if (!op)
+        {
+            std::cerr << test.path << "/" << test.op << ": not available" << std::endl;
+            return;
+        }
+        ops.push_back(op);
+    }
+
+    std::vector<std::vector<uint64_t>> samples(threads);
+    std::atomic<size_t> ready{0};
+    std::atomic<size_t> errors{0};
+    std::atomic<bool>   start{false};
+    std::vector<std::thread> pool;
+
+    for (size_t t = 0; t < threads; t++)
+    {
+        pool.emplace_back([&, t]() {
+            auto & lat = samples[t];
+            lat.reserve(iters);
+
+            ready++;
+            while (!start.load()) {}
+
+            for (size_t i = 0; i < iters; i++)
+            {
+                auto begin = std::chrono::steady_clock::now();
+                bool ok    = ops[t](i);
+                auto end   = std::chrono::steady_clock::now();
+
+                if (!ok)
+                    errors++;
+                lat.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                  end - begin).count());
+            }
+        });
+    }
+
+    while (ready.load() != threads) {}
+    auto begin = std::chrono::steady_clock::now();
+    start = true;
+    for (auto & th : pool)
+        th.join();
+    auto wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin);
+
+    std::vector<uint64_t> all;
+    for (auto & lat : samples)
+        all.insert(all.end(), lat.begin(), lat.end());
+    std::sort(all.begin(), all.end());
+
+    auto pct = [&all](double p) {
+        return all[std::min(all.size() - 1, static_cast<size_t>(p * all.size()))];
+    };
+
+    std::cout << test.path << ',' << test.op << ',' << threads << ','
+              << all.size() << ',' << errors.load() << ','
+              << static_cast<uint64_t>(all.size() / wall.count()) << ','
+              << pct(0.50) << ',' << pct(0.90) << ',' << pct(0.99) << ','
+              << pct(0.999) << ',' << all.back() << std::endl;
+}
+
+//=============================================================================
+
+// Разобрать аргументы командной строки.
+static bool parse(int argc, char * argv[], SOptions & opt)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool next = (i + 1 < argc);
+
+        if (arg == "--sim")
+            opt.sim = true;
+        else if (arg == "-d" && next)
+            opt.device = argv[++i];
+        else if (arg == "-t" && next)
+            opt.threads = std::stoul(argv[++i]);
+        else if (arg == "-n" && next)
+            opt.iters = std::stoul(argv[++i]);
+        else
+            return false;
+    }
+
+    return opt.threads > 0 && opt.iters > 0;
+}
+
+//-----------------------------------------------------------------------------
+
+int main(int argc, char * argv[])
+{
+    SOptions opt;
+    if (!parse(argc, argv, opt))
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " [-d device] [-t threads] [-n iterations] [--sim]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    auto cases = opt.sim ? simCases() : deviceCases(opt);
+
+    std::cout << "path,op,threads,ops,errors,ops_per_sec,"
+                 "p50_ns,p90_ns,p99_ns,p999_ns,max_ns" << std::endl;
+
+    for (auto & test : cases)
+    {
+        run(test, 1, opt.iters);
+        if (opt.threads > 1)
+            run(test, opt.threads, opt.iters);
+    }
+
+    return EXIT_SUCCESS;
+}
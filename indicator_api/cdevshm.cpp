@@ -0,0 +1,156 @@
+#include "cdevshm.h"
+
+#include <cstring>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace dev
+{
+namespace shm
+{
+
+//=============================================================================
+
+CDevShm::CDevShm() 
+    : m_shared{nullptr}, m_device{0}, m_mem{nullptr}, m_seq{0}, m_written{} {}
+
+CDevShm::~CDevShm() { devClose(); }
+
+//=============================================================================
+
+// Подключиться к демону и выбрать устройство.
+bool CDevShm::devOpen(uint32_t device, const std::string & name)
+{
+    devClose();
+
+    auto fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0)
+        return false;
+
+    auto addr = mmap(nullptr, sizeof(::drv::shm::SShared), PROT_READ | PROT_WRITE,
+                     MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (addr == MAP_FAILED)
+        return false;
+
+    auto shared = static_cast<::drv::shm::SShared *>(addr);
+    if (!::drv::shm::alive(shared) || device >= shared->devices)
+    {
+        munmap(addr, sizeof(::drv::shm::SShared));
+        return false;
+    }
+
+    m_shared = shared;
+    m_device = device;
+    m_seq    = 0;
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+// Отключиться от демона.
+void CDevShm::devClose()
+{
+    if (m_shared == nullptr)
+        return;
+
+    munmap(m_shared, sizeof(::drv::shm::SShared));
+    m_shared = nullptr;
+}
+
+//=============================================================================
+
+// Прочитать регион, примененный демоном.
+bool CDevShm::devRead()
+{
+    auto count = regCount();
+    if (count == 0 || !attached())
+        return false;
+
+    auto data = static_cast<uint32_t *>(m_mem->getData());
+
+    // Reading back right after a write must not return the previous state.
+    if (m_shared->applied[m_device].load(std::memory_order_acquire) < m_seq)
+    {
+        std::memcpy(data, m_written, count * sizeof(uint32_t));
+        return true;
+    }
+
+    for (size_t i = 0; i < count; i++)
+        data[i] = m_shared->regs[m_device][i].load(std::memory_order_acquire);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+// Передать регион демону.
+bool CDevShm::devWrite()
+{
+    auto count = regCount();
+    if (count == 0 || !attached())
+        return false;
+
+    ::drv::shm::SRequest req{};
+    req.device = m_device;
+    req.count  = static_cast<uint32_t>(count);
+    std::memcpy(req.regs, m_mem->getData(), count * sizeof(uint32_t));
+
+    auto seq = ::drv::shm::push(m_shared, req);
+    if (seq == 0)
+        return false;
+
+    m_seq = seq;
+    std::memcpy(m_written, req.regs, count * sizeof(uint32_t));
+
+    // Only a sleeping daemon costs the client a syscall; the fence pairs
+    // with the one the daemon issues between raising idle and its last pop.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_shared->idle.load(std::memory_order_relaxed) != 0 &&
+        m_shared->idle.exchange(0) != 0)
+    {
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(&m_shared->idle),
+                FUTEX_WAKE, 1, nullptr, nullptr, 0);
+    }
+
+    return true;
+}
+
+//=============================================================================
+
+// Проверить, что демон по-прежнему обслуживает память.
+bool CDevShm::attached()
+{
+    if (::drv::shm::alive(m_shared))
+        return true;
+
+    // The daemon exited or was replaced, the segment is nobody's now.
+    devClose();
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+
+// Количество регистров региона.
+size_t CDevShm::regCount() const
+{
+    if (m_shared == nullptr || m_mem == nullptr)
+        return 0;
+
+    auto count = m_mem->getSize() / sizeof(uint32_t);
+    if (count == 0 || count > ::drv::shm::s_maxRegs)
+        return 0;
+
+    return count;
+}
+
+//=============================================================================
+
+} // namespace shm
+} // namespace dev
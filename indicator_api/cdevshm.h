@@ -0,0 +1,80 @@
+#ifndef DEV_SHM_CDEVSHM_H
+#define DEV_SHM_CDEVSHM_H
+
+#include <string>
+
+#include "global-module/types.h"
+#include "device-library/cdevsym.h"
+#include "indicatordshm.h"
+
+namespace dev
+{
+namespace shm
+{
+
+using namespace api::dev;
+
+//=============================================================================
+
+// Клиент демона indicatord: устройство доступно через общую память.
+// Подключается так же, как CDevSym: setMemIO() / getIntDevIO().
+// Запись публикует регион в кольцо, чтение берет значения,
+// примененные демоном, - без системных вызовов. Пока демон не применил
+// последнюю запись клиента, чтение возвращает записанные значения.
+// После завершения или перезапуска демона чтение и запись завершаются
+// ошибкой, пока клиент заново не вызовет devOpen().
+class CDevShm : public IDevIO
+{
+public:
+    CDevShm();
+    ~CDevShm() override;
+
+    //-------------------------------------------------------------------------
+
+    // Подключиться к демону и выбрать устройство.
+    bool devOpen(uint32_t device, const std::string & name = ::drv::shm::s_name);
+
+    // Отключиться от демона.
+    void devClose();
+
+    //-------------------------------------------------------------------------
+
+    // Задать интерфейс памяти региона.
+    void setMemIO(IMemIO * mem) { m_mem = mem; }
+
+    // Запросить интерфейс устройства.
+    IDevIO * getIntDevIO() { return this; }
+
+    //-------------------------------------------------------------------------
+
+    // Прочитать регион, примененный демоном.
+    bool devRead() override;
+
+    // Передать регион демону.
+    bool devWrite() override;
+
+private:
+    //-------------------------------------------------------------------------
+
+    // Проверить, что демон по-прежнему обслуживает память
+    // (иначе отключиться).
+    bool attached();
+
+    // Количество регистров региона (0 - регион не подходит).
+    size_t regCount() const;
+
+    //-------------------------------------------------------------------------
+
+    ::drv::shm::SShared * m_shared;   // Общая память.
+    uint32_t m_device;              // Номер устройства у демона.
+    IMemIO * m_mem;                 // Память региона.
+    uint64_t m_seq;                 // Номер последней записи (0 - не было).
+    uint32_t m_written[::drv::shm::s_maxRegs];  // Записанные значения.
+};
+
+//=============================================================================
+
+} // namespace shm
+} // namespace dev
+
+#endif // DEV_SHM_CDEVSHM_H
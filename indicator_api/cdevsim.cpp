@@ -0,0 +1,122 @@
+#include "cdevsim.h"
+
+#include <cstring>
+
+namespace dev
+{
+namespace sim
+{
+
+//=============================================================================
+
+CDevSim::CDevSim(size_t regs, uint32_t bitmask)
+    : m_regs(regs, 0x00U), m_bitmask{bitmask}, m_latency{0}, m_mem{nullptr},
+      m_reads{0}, m_writes{0} {}
+
+CDevSim::~CDevSim() {}
+
+//=============================================================================
+
+// Задать интерфейс памяти региона.
+void CDevSim::setMemIO(IMemIO * mem)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_mem = mem;
+}
+
+//-----------------------------------------------------------------------------
+
+// Задать задержку одного обращения к регистру.
+void CDevSim::setLatency(std::chrono::nanoseconds latency)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_latency = latency;
+}
+
+//=============================================================================
+
+// Прочитать регион устройства в память (аналог read()).
+bool CDevSim::devRead()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    // The driver rejects anything but a whole region.
+    if (m_mem == nullptr || m_mem->getSize() != m_regs.size() * sizeof(uint32_t))
+        return false;
+
+    auto data = static_cast<uint32_t *>(m_mem->getData());
+    for (size_t i = 0; i < m_regs.size(); i++)
+    {
+        // Write-only registers come from the driver's shadow copy,
+        // which always holds the last written value.
+        if (isReadable(i))
+            busDelay();
+
+        data[i] = (isReadable(i) || isWritable(i)) ? m_regs[i] : 0x00U;
+    }
+
+    m_reads++;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+// Записать регион из памяти в устройство (аналог write()).
+bool CDevSim::devWrite()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if (m_mem == nullptr || m_mem->getSize() != m_regs.size() * sizeof(uint32_t))
+        return false;
+
+    auto data = static_cast<const uint32_t *>(m_mem->getData());
+    for (size_t i = 0; i < m_regs.size(); i++)
+    {
+        // Read-only registers ignore writes, as in region_write().
+        if (!isWritable(i))
+            continue;
+
+        busDelay();
+        m_regs[i] = data[i];
+    }
+
+    m_writes++;
+    return true;
+}
+
+//=============================================================================
+
+// Запросить значение регистра со стороны "оборудования".
+uint32_t CDevSim::getReg(size_t index)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return (index < m_regs.size()) ? m_regs[index] : 0x00U;
+}
+
+//-----------------------------------------------------------------------------
+
+// Задать значение регистра со стороны "оборудования".
+void CDevSim::setReg(size_t index, uint32_t value)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    if (index < m_regs.size())
+        m_regs[index] = value;
+}
+
+//=============================================================================
+
+// Выдержать задержку обращения к шине.
+void CDevSim::busDelay() const
+{
+    if (m_latency.count() == 0)
+        return;
+
+    // MMIO stalls the CPU, so spin instead of sleeping.
+    auto until = std::chrono::steady_clock::now() + m_latency;
+    while (std::chrono::steady_clock::now() < until) {}
+}
+
+//=============================================================================
+
+} // namespace sim
+} // namespace dev
@@ -0,0 +1,93 @@
+#ifndef DEV_SIM_CDEVSIM_H
+#define DEV_SIM_CDEVSIM_H
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#include "global-module/types.h"
+#include "device-library/cdevsym.h"
+
+namespace dev
+{
+namespace sim
+{
+
+using namespace api::dev;
+
+//=============================================================================
+
+// Имитация IP-Core индикатора в памяти (для стендов без ПЛИС).
+// Подключается так же, как CDevSym: setMemIO() / getIntDevIO().
+class CDevSim : public IDevIO
+{
+public:
+    // Параметры по умолчанию совпадают с драйвером:
+    // REGISTER_COUNT = 1, регистр доступен на чтение и запись (0x3).
+    explicit CDevSim(size_t regs = 0x01U, uint32_t bitmask = 0x03U);
+    ~CDevSim() override;
+
+    //-------------------------------------------------------------------------
+
+    // Задать интерфейс памяти региона.
+    void setMemIO(IMemIO * mem);
+
+    // Запросить интерфейс устройства.
+    IDevIO * getIntDevIO() { return this; }
+
+    //-------------------------------------------------------------------------
+
+    // Задать задержку одного обращения к регистру.
+    void setLatency(std::chrono::nanoseconds latency);
+
+    //-------------------------------------------------------------------------
+
+    // Прочитать регион устройства в память (аналог read()).
+    bool devRead() override;
+
+    // Записать регион из памяти в устройство (аналог write()).
+    bool devWrite() override;
+
+    //-------------------------------------------------------------------------
+
+    // Запросить значение регистра со стороны "оборудования".
+    uint32_t getReg(size_t index);
+
+    // Задать значение регистра со стороны "оборудования".
+    void setReg(size_t index, uint32_t value);
+
+    //-------------------------------------------------------------------------
+
+    // Количество выполненных чтений и записей региона.
+    uint64_t getReads() const { return m_reads.load(); }
+    uint64_t getWrites() const { return m_writes.load(); }
+
+private:
+    //-------------------------------------------------------------------------
+
+    // Проверить доступ к регистру (2 бита на регистр: запись, чтение).
+    bool isReadable(size_t index) const { return (m_bitmask >> (index * 2)) & 0b01U; }
+    bool isWritable(size_t index) const { return (m_bitmask >> (index * 2)) & 0b10U; }
+
+    // Выдержать задержку обращения к шине.
+    void busDelay() const;
+
+    //-------------------------------------------------------------------------
+
+    std::vector<uint32_t> m_regs;           // Регистры IP-Core.
+    uint32_t m_bitmask;                     // Маска доступных регистров.
+    std::chrono::nanoseconds m_latency;     // Задержка обращения.
+    IMemIO * m_mem;                         // Память региона.
+    std::mutex m_lock;                      // Аналог access_lock драйвера.
+
+    std::atomic<uint64_t> m_reads;
+    std::atomic<uint64_t> m_writes;
+};
+
+//=============================================================================
+
+} // namespace sim
+} // namespace dev
+
+#endif // DEV_SIM_CDEVSIM_H
@@ -1,7 +1,7 @@
 #ifndef DRV_CINDICATOR_H
 #define DRV_CINDICATOR_H
 
-#include "iindicator.h"
+#include "ilockableindicator.h"
 #include "device-library/cdrvreg.h"
 
 namespace drv
@@ -12,7 +12,7 @@ using namespace dev::drv;
 
 //=============================================================================
 
-class CIndicator : public CDriverRegion, public IIndicator
+class CIndicator : public CDriverRegion, public ILockableIndicator
 {
 public:
     CIndicator();
@@ -33,6 +33,12 @@ public:
     // Запросить интерфейс региона.
     IDriverRegion & region() override { return CDriverRegion::region(); }
 
+    //-------------------------------------------------------------------------
+
+    // Захватить и освободить локальный регион.
+    void lockRegion() override { lock(); }
+    void unlockRegion() override { unlock(); }
+
 private:
     //-------------------------------------------------------------------------
 
@@ -0,0 +1,145 @@
+#include "cindicatorcompositor.h"
+
+namespace drv
+{
+
+//=============================================================================
+
+CIndicatorCompositor::CIndicatorCompositor(IIndicator * target)
+    : m_target{target}, m_colors{}, m_sources{0}, m_active{0},
+      m_current{IIndicator::color_t::OFF}, m_writes{0}
+{
+    // Start from what the indicator shows, so the first post that
+    // matches it does not touch the bus.
+    if (m_target->region().recv())
+        m_current = m_target->getColor();
+}
+
+CIndicatorCompositor::~CIndicatorCompositor() {}
+
+//=============================================================================
+
+// Зарегистрировать источник с приоритетом.
+bool CIndicatorCompositor::addSource(size_t priority)
+{
+    if (priority >= s_levels)
+        return false;
+
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    auto bit = uint64_t{1} << priority;
+    if (m_sources & bit)
+        return false;
+
+    m_sources |= bit;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+// Удалить источник.
+void CIndicatorCompositor::removeSource(size_t priority)
+{
+    if (priority >= s_levels)
+        return;
+
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    auto bit = uint64_t{1} << priority;
+    m_sources &= ~bit;
+
+    if (m_active & bit)
+    {
+        m_active &= ~bit;
+        resolve();
+    }
+}
+
+//=============================================================================
+
+// Задать желаемый цвет источника.
+bool CIndicatorCompositor::post(size_t priority, IIndicator::color_t color)
+{
+    if (priority >= s_levels)
+        return false;
+
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    auto bit = uint64_t{1} << priority;
+    if (!(m_sources & bit))
+        return false;
+
+    m_colors[priority] = color;
+    m_active |= bit;
+
+    // A source below the winner can't change the output.
+    if (m_active >> priority == 1)
+        resolve();
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+// Снять цвет источника.
+bool CIndicatorCompositor::clear(size_t priority)
+{
+    if (priority >= s_levels)
+        return false;
+
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    auto bit = uint64_t{1} << priority;
+    if (!(m_sources & bit))
+        return false;
+
+    if (m_active & bit)
+    {
+        m_active &= ~bit;
+        resolve();
+    }
+
+    return true;
+}
+
+//=============================================================================
+
+// Запросить действующий цвет.
+IIndicator::color_t CIndicatorCompositor::getColor()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_current;
+}
+
+//-----------------------------------------------------------------------------
+
+// Количество записей в индикатор.
+uint64_t CIndicatorCompositor::getWrites()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_writes;
+}
+
+//=============================================================================
+
+// Найти победивший цвет и записать его при смене.
+void CIndicatorCompositor::resolve()
+{
+    auto color = IIndicator::color_t::OFF;
+    if (m_active != 0)
+        color = m_colors[s_levels - 1 - __builtin_clzll(m_active)];
+
+    if (color == m_current)
+        return;
+
+    m_target->setColor(color);
+    if (m_target->region().send())
+    {
+        m_current = color;
+        m_writes++;
+    }
+}
+
+//=============================================================================
+
+} // namespace drv
@@ -0,0 +1,75 @@
+#ifndef DRV_CINDICATORCOMPOSITOR_H
+#define DRV_CINDICATORCOMPOSITOR_H
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+
+#include "iindicator.h"
+
+namespace drv
+{
+
+//=============================================================================
+
+// Компоновщик цветов: несколько источников (аварии, связь, активность)
+// делят один индикатор. Каждый источник занимает уровень приоритета,
+// побеждает старший активный уровень (поиск за O(1) по битовой маске).
+// Индикатор записывается только при смене победившего цвета.
+class CIndicatorCompositor
+{
+public:
+    // Количество уровней приоритета (0 - младший).
+    constexpr static const size_t s_levels = 64U;
+
+    //-------------------------------------------------------------------------
+
+    explicit CIndicatorCompositor(IIndicator * target);
+    ~CIndicatorCompositor();
+
+    //-------------------------------------------------------------------------
+
+    // Зарегистрировать источник с приоритетом (false - уровень занят).
+    bool addSource(size_t priority);
+
+    // Удалить источник (его цвет снимается).
+    void removeSource(size_t priority);
+
+    //-------------------------------------------------------------------------
+
+    // Задать желаемый цвет источника.
+    bool post(size_t priority, IIndicator::color_t color);
+
+    // Снять цвет источника.
+    bool clear(size_t priority);
+
+    //-------------------------------------------------------------------------
+
+    // Запросить действующий цвет.
+    IIndicator::color_t getColor();
+
+    // Количество записей в индикатор.
+    uint64_t getWrites();
+
+private:
+    //-------------------------------------------------------------------------
+
+    // Найти победивший цвет и записать его при смене.
+    void resolve();
+
+    //-------------------------------------------------------------------------
+
+    IIndicator * m_target;                              // Индикатор.
+    std::array<IIndicator::color_t, s_levels> m_colors; // Цвета уровней.
+    uint64_t m_sources;                                 // Занятые уровни.
+    uint64_t m_active;                                  // Уровни с цветом.
+    IIndicator::color_t m_current;                      // Записанный цвет.
+    uint64_t m_writes;
+    std::mutex m_lock;
+};
+
+//=============================================================================
+
+} // namespace drv
+
+#endif // DRV_CINDICATORCOMPOSITOR_H
@@ -0,0 +1,148 @@
+#include "cindicatorio.h"
+
+#include <stdexcept>
+
+namespace drv
+{
+
+//=============================================================================
+
+CIndicatorIO::CIndicatorIO() : m_running{true}
+{
+    m_thread = std::thread(&CIndicatorIO::run, this);
+}
+
+CIndicatorIO::~CIndicatorIO()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_running = false;
+    }
+
+    // Operations already queued are still completed.
+    m_wake.notify_one();
+    m_thread.join();
+}
+
+//=============================================================================
+
+// Задать цвет.
+std::future<bool> CIndicatorIO::setColorAsync(IIndicator * indicator,
+                                              IIndicator::color_t color)
+{
+    SOp op{true, color, {}, {}};
+    auto future = op.sent.get_future();
+
+    submit(indicator, std::move(op));
+    return future;
+}
+
+//-----------------------------------------------------------------------------
+
+// Запросить цвет.
+std::future<IIndicator::color_t> CIndicatorIO::getColorAsync(IIndicator * indicator)
+{
+    SOp op{false, IIndicator::color_t::OFF, {}, {}};
+    auto future = op.received.get_future();
+
+    submit(indicator, std::move(op));
+    return future;
+}
+
+//=============================================================================
+
+// Поставить операцию в очередь устройства.
+void CIndicatorIO::submit(IIndicator * indicator, SOp && op)
+{
+    bool wake;
+
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+
+        auto & ops = m_pending[indicator];
+        if (ops.empty())
+            m_ready.push_back(indicator);
+
+        ops.push_back(std::move(op));
+        wake = m_ready.size() == 1;
+    }
+
+    // The thread is busy while other devices are ready.
+    if (wake)
+        m_wake.notify_one();
+}
+
+//-----------------------------------------------------------------------------
+
+// Выполнить накопленные операции устройства.
+void CIndicatorIO::process(IIndicator * indicator, std::vector<SOp> & ops)
+{
+    for (size_t first = 0; first < ops.size();)
+    {
+        // Split into runs of the same kind, a get must see earlier sets.
+        auto last = first;
+        while (last + 1 < ops.size() && ops[last + 1].set == ops[first].set)
+            last++;
+
+        if (ops[first].set)
+        {
+            indicator->setColor(ops[last].color);
+            auto sent = indicator->region().send();
+
+            for (auto i = first; i <= last; i++)
+                ops[i].sent.set_value(sent);
+        }
+        else
+        {
+            auto received = indicator->region().recv();
+            auto color = indicator->getColor();
+
+            for (auto i = first; i <= last; i++)
+            {
+                if (received)
+                    ops[i].received.set_value(color);
+                else
+                    ops[i].received.set_exception(std::make_exception_ptr(
+                        std::runtime_error("can't receive indicator region")));
+            }
+        }
+
+        first = last + 1;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+// Цикл потока.
+void CIndicatorIO::run()
+{
+    std::vector<SOp> ops;
+
+    while (true)
+    {
+        IIndicator * indicator;
+
+        {
+            std::unique_lock<std::mutex> guard(m_lock);
+            m_wake.wait(guard, [this] { return !m_ready.empty() || !m_running; });
+
+            if (m_ready.empty())
+                break;
+
+            // Devices are served round-robin, each gets its whole backlog.
+            indicator = m_ready.front();
+            m_ready.pop_front();
+
+            auto it = m_pending.find(indicator);
+            ops.swap(it->second);
+            m_pending.erase(it);
+        }
+
+        process(indicator, ops);
+        ops.clear();
+    }
+}
+
+//=============================================================================
+
+} // namespace drv
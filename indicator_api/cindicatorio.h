@@ -0,0 +1,75 @@
+#ifndef DRV_CINDICATORIO_H
+#define DRV_CINDICATORIO_H
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "iindicator.h"
+
+namespace drv
+{
+
+//=============================================================================
+
+// Асинхронный доступ к индикаторам: операции выполняет поток ввода-вывода,
+// вызывающий получает std::future. Накопившиеся операции одного
+// устройства объединяются: подряд идущие записи дают одну отправку
+// (последнего цвета), подряд идущие чтения - одно чтение региона.
+class CIndicatorIO
+{
+public:
+    CIndicatorIO();
+    ~CIndicatorIO();
+
+    //-------------------------------------------------------------------------
+
+    // Задать цвет (future - результат отправки региона).
+    std::future<bool> setColorAsync(IIndicator * indicator,
+                                    IIndicator::color_t color);
+
+    // Запросить цвет (при ошибке чтения future содержит исключение).
+    std::future<IIndicator::color_t> getColorAsync(IIndicator * indicator);
+
+private:
+    //-------------------------------------------------------------------------
+
+    // Операция над устройством.
+    struct SOp
+    {
+        bool set;
+        IIndicator::color_t color;
+        std::promise<bool> sent;
+        std::promise<IIndicator::color_t> received;
+    };
+
+    //-------------------------------------------------------------------------
+
+    // Поставить операцию в очередь устройства.
+    void submit(IIndicator * indicator, SOp && op);
+
+    // Выполнить накопленные операции устройства.
+    void process(IIndicator * indicator, std::vector<SOp> & ops);
+
+    // Цикл потока.
+    void run();
+
+    //-------------------------------------------------------------------------
+
+    std::unordered_map<IIndicator *, std::vector<SOp>> m_pending;
+    std::deque<IIndicator *> m_ready;       // Устройства с операциями.
+    std::mutex m_lock;
+    std::condition_variable m_wake;
+    bool m_running;
+    std::thread m_thread;
+};
+
+//=============================================================================
+
+} // namespace drv
+
+#endif // DRV_CINDICATORIO_H
@@ -0,0 +1,103 @@
+#include "cindicatormap.h"
+#include "indicatorregmap.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+namespace drv
+{
+
+//=============================================================================
+
+CIndicatorMap::CIndicatorMap()
+    : CDriverRegion{s_regs}, m_map{nullptr}, m_mapSize{0}, m_regs{nullptr} {}
+
+CIndicatorMap::~CIndicatorMap() { mapClose(); }
+
+//=============================================================================
+
+// Отобразить окно регистров устройства.
+bool CIndicatorMap::mapOpen(const std::string & path)
+{
+    mapClose();
+
+    int fd = ::open(path.c_str(), O_RDWR | O_SYNC);
+    if (fd < 0)
+        return false;
+
+    // The driver maps only a page-aligned window, registers start at 0.
+    auto page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    auto size = (s_regs * sizeof(uint32_t) + page - 1) & ~(page - 1);
+    auto map  = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    // The mapping stays valid after the descriptor is closed.
+    ::close(fd);
+
+    if (map == MAP_FAILED)
+        return false;
+
+    m_map     = map;
+    m_mapSize = size;
+    m_regs    = static_cast<volatile uint32_t *>(map);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+// Снять отображение окна регистров.
+void CIndicatorMap::mapClose()
+{
+    if (m_map == nullptr)
+        return;
+
+    ::munmap(m_map, m_mapSize);
+
+    m_map     = nullptr;
+    m_mapSize = 0;
+    m_regs    = nullptr;
+}
+
+//=============================================================================
+
+// Запросить цвет.
+IIndicator::color_t CIndicatorMap::getColor()
+{
+    using color = regmap::indicator::color;
+
+    if (isMapped())
+        return color::decode(m_regs[color::index]);
+
+    lock();
+    auto value = color::decode(lReg<uint32_t>(color::index));
+    unlock();
+
+    return value;
+}
+
+//-----------------------------------------------------------------------------
+
+// Задать цвет.
+void CIndicatorMap::setColor(const color_t & type)
+{
+    using color = regmap::indicator::color;
+
+    // A single uncached store, no syscall and no lock, while the color 
+    // is the only field of its register.
+    if (isMapped())
+    {
+        auto & reg = m_regs[color::index];
+        reg = color::exclusive ? color::encode(type) : color::insert(reg, type);
+        return;
+    }
+
+    lock();
+    auto & reg = lReg<uint32_t>(color::index);
+    reg = color::insert(reg, type);
+    unlock();
+}
+
+//=============================================================================
+
+} // namespace drv
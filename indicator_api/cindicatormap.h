@@ -0,0 +1,78 @@
+#ifndef DRV_CINDICATORMAP_H
+#define DRV_CINDICATORMAP_H
+
+#include <string>
+
+#include "ilockableindicator.h"
+#include "device-library/cdrvreg.h"
+
+namespace drv
+{
+
+using namespace api::dev;
+using namespace dev::drv;
+
+//=============================================================================
+
+// Индикатор с прямым доступом к регистрам через mmap() драйвера.
+// Пока окно не отображено, работает как CIndicator (через локальный регион).
+class CIndicatorMap : public CDriverRegion, public ILockableIndicator
+{
+public:
+    CIndicatorMap();
+    ~CIndicatorMap() override;
+
+    //-------------------------------------------------------------------------
+
+    // Отобразить окно регистров устройства (окно должно быть выровнено
+    // по странице, иначе драйвер отказывает в отображении).
+    bool mapOpen(const std::string & path);
+
+    // Снять отображение окна регистров.
+    void mapClose();
+
+    // Проверить, отображено ли окно регистров.
+    bool isMapped() const { return m_regs != nullptr; }
+
+    // Запросить окно регистров (nullptr, если не отображено).
+    volatile uint32_t * regs() const { return m_regs; }
+
+    //-------------------------------------------------------------------------
+
+    // Запросить цвет.
+    color_t getColor() override;
+
+    //-------------------------------------------------------------------------
+
+    // Задать цвет.
+    void setColor(const color_t & type) override;
+
+    //-------------------------------------------------------------------------
+
+    // Запросить интерфейс региона.
+    IDriverRegion & region() override { return CDriverRegion::region(); }
+
+    //-------------------------------------------------------------------------
+
+    // Захватить и освободить локальный регион.
+    void lockRegion() override { lock(); }
+    void unlockRegion() override { unlock(); }
+
+private:
+    //-------------------------------------------------------------------------
+
+    // Количество регистров.
+    constexpr static const size_t s_regs = 0x01U;
+
+    //-------------------------------------------------------------------------
+
+    void   * m_map;                     // Отображенные страницы.
+    size_t   m_mapSize;                 // Размер отображения.
+    volatile uint32_t * m_regs;         // Начало окна регистров.
+};
+
+//=============================================================================
+
+} // namespace drv
+
+#endif // DRV_CINDICATORMAP_H
@@ -0,0 +1,202 @@
+#include "cindicatorreactor.h"
+#include "indicatorregmap.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace drv
+{
+
+//=============================================================================
+
+CIndicatorReactor::SWatch::SWatch(int fd, const std::string & path, callback_t callback)
+    : fd{fd}, path{path}, callback{std::move(callback)} {}
+
+CIndicatorReactor::SWatch::~SWatch() { close(fd); }
+
+//=============================================================================
+
+CIndicatorReactor::CIndicatorReactor() : m_running{false}
+{
+    m_epoll = epoll_create1(EPOLL_CLOEXEC);
+    m_stop  = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+    if (m_epoll >= 0 && m_stop >= 0)
+    {
+        epoll_event event{};
+        event.events  = EPOLLIN;
+        event.data.fd = m_stop;
+        epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_stop, &event);
+    }
+}
+
+CIndicatorReactor::~CIndicatorReactor()
+{
+    stop();
+
+    m_watches.clear();
+    m_paths.clear();
+
+    if (m_stop >= 0)
+        close(m_stop);
+
+    if (m_epoll >= 0)
+        close(m_epoll);
+}
+
+//=============================================================================
+
+// Запустить поток реактора.
+bool CIndicatorReactor::start()
+{
+    if (m_epoll < 0 || m_stop < 0)
+        return false;
+
+    if (m_running.exchange(true))
+        return true;
+
+    m_thread = std::thread(&CIndicatorReactor::run, this);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+// Остановить поток реактора.
+void CIndicatorReactor::stop()
+{
+    if (!m_running.exchange(false))
+        return;
+
+    // EAGAIN means the counter is already signalled, the thread wakes anyway.
+    uint64_t one = 1;
+    while (write(m_stop, &one, sizeof(one)) < 0 && errno == EINTR) {}
+
+    // The thread is always joined, a joinable one would terminate us.
+    m_thread.join();
+
+    // Leave the eventfd unsignalled for the next start().
+    uint64_t value;
+    if (read(m_stop, &value, sizeof(value)) != sizeof(value))
+        return;
+}
+
+//=============================================================================
+
+// Следить за устройством.
+bool CIndicatorReactor::add(const std::string & path, callback_t callback)
+{
+    if (m_epoll < 0 || !callback)
+        return false;
+
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if (m_paths.count(path))
+        return false;
+
+    // The reactor only reads; the region is written by the owners.
+    auto fd = open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+
+    auto watch = std::make_shared<SWatch>(fd, path, std::move(callback));
+
+    // Level-triggered: the driver clears POLLIN once the region is read.
+    epoll_event event{};
+    event.events  = EPOLLIN;
+    event.data.fd = fd;
+    if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &event) < 0)
+        return false;
+
+    m_watches[fd]  = watch;
+    m_paths[path]  = fd;
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+// Прекратить слежение за устройством.
+void CIndicatorReactor::remove(const std::string & path)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    auto it = m_paths.find(path);
+    if (it == m_paths.end())
+        return;
+
+    // A dispatch in progress keeps the watch, and the fd, alive.
+    epoll_ctl(m_epoll, EPOLL_CTL_DEL, it->second, nullptr);
+    m_watches.erase(it->second);
+    m_paths.erase(it);
+}
+
+//=============================================================================
+
+// Прочитать регион и вызвать обработчик (false - устройство неисправно).
+bool CIndicatorReactor::dispatch(const SWatch & watch)
+{
+    using color = regmap::indicator::color;
+
+    // A whole-region read also acknowledges the change to the driver.
+    uint32_t regs[regmap::indicator::regs];
+    ssize_t size;
+    do
+    {
+        size = pread(watch.fd, regs, sizeof(regs), 0);
+    } while (size < 0 && errno == EINTR);
+
+    // Level-triggered EPOLLIN stays set until a read succeeds, so any
+    // other failure, EAGAIN included, drops the device instead of spinning.
+    if (size != static_cast<ssize_t>(sizeof(regs)))
+        return false;
+
+    watch.callback(watch.path, color::decode(regs[color::index]));
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+// Цикл потока.
+void CIndicatorReactor::run()
+{
+    epoll_event events[s_events];
+    std::vector<std::shared_ptr<SWatch>> ready;
+
+    while (m_running.load())
+    {
+        auto count = epoll_wait(m_epoll, events, s_events, -1);
+        if (count < 0)
+            continue;
+
+        ready.clear();
+
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+
+            for (int i = 0; i < count; i++)
+            {
+                auto it = m_watches.find(events[i].data.fd);
+                if (it != m_watches.end())
+                    ready.push_back(it->second);
+            }
+        }
+
+        // Callbacks run unlocked, so they may add or remove devices.
+        // A device that can't be read would keep EPOLLIN set forever.
+        for (auto & watch : ready)
+        {
+            if (!dispatch(*watch))
+                remove(watch->path);
+        }
+    }
+}
+
+//=============================================================================
+
+} // namespace drv
@@ -0,0 +1,92 @@
+#ifndef DRV_CINDICATORREACTOR_H
+#define DRV_CINDICATORREACTOR_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "iindicator.h"
+
+namespace drv
+{
+
+//=============================================================================
+
+// Реактор изменений: один поток и один epoll на любое число индикаторов.
+// Драйвер сообщает POLLIN только после изменения региона, поэтому поток
+// просыпается лишь на реальные события. Обработчик получает цвет,
+// прочитанный из региона устройства.
+class CIndicatorReactor
+{
+public:
+    using callback_t = std::function<void(const std::string & path,
+                                          IIndicator::color_t color)>;
+
+    //-------------------------------------------------------------------------
+
+    CIndicatorReactor();
+    ~CIndicatorReactor();
+
+    //-------------------------------------------------------------------------
+
+    // Запустить поток реактора.
+    bool start();
+
+    // Остановить поток реактора.
+    void stop();
+
+    //-------------------------------------------------------------------------
+
+    // Следить за устройством (например, /dev/indicator_driver_40000000).
+    bool add(const std::string & path, callback_t callback);
+
+    // Прекратить слежение за устройством.
+    void remove(const std::string & path);
+
+private:
+    //-------------------------------------------------------------------------
+
+    // Отслеживаемое устройство (дескриптор закрывается вместе с ним).
+    struct SWatch
+    {
+        SWatch(int fd, const std::string & path, callback_t callback);
+        ~SWatch();
+
+        int         fd;
+        std::string path;
+        callback_t  callback;
+    };
+
+    //-------------------------------------------------------------------------
+
+    // Прочитать регион и вызвать обработчик (false - устройство неисправно).
+    bool dispatch(const SWatch & watch);
+
+    // Цикл потока.
+    void run();
+
+    //-------------------------------------------------------------------------
+
+    // Количество событий за один вызов epoll_wait().
+    constexpr static const int s_events = 64;
+
+    //-------------------------------------------------------------------------
+
+    int m_epoll;                            // Экземпляр epoll.
+    int m_stop;                             // eventfd остановки.
+    std::unordered_map<int, std::shared_ptr<SWatch>> m_watches;   // По fd.
+    std::unordered_map<std::string, int> m_paths;
+    std::mutex m_lock;
+    std::atomic<bool> m_running;
+    std::thread m_thread;
+};
+
+//=============================================================================
+
+} // namespace drv
+
+#endif // DRV_CINDICATORREACTOR_H
@@ -0,0 +1,242 @@
+#include "cindicatorscheduler.h"
+
+#include <algorithm>
+
+namespace drv
+{
+
+//=============================================================================
+
+constexpr const std::chrono::milliseconds CIndicatorScheduler::s_tick;
+
+CIndicatorScheduler::CIndicatorScheduler()
+    : m_tick{0}, m_sending{false}, m_running{false} {}
+
+CIndicatorScheduler::~CIndicatorScheduler() { stop(); }
+
+//=============================================================================
+
+// Запустить поток планировщика.
+void CIndicatorScheduler::start()
+{
+    if (m_running.exchange(true))
+        return;
+
+    m_thread = std::thread(&CIndicatorScheduler::run, this);
+}
+
+//-----------------------------------------------------------------------------
+
+// Остановить поток планировщика.
+void CIndicatorScheduler::stop()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        if (!m_running.exchange(false))
+            return;
+    }
+
+    m_wake.notify_all();
+    m_thread.join();
+}
+
+//=============================================================================
+
+// Проиграть шаблон на индикаторе.
+bool CIndicatorScheduler::play(IIndicator * indicator, const pattern_t & pattern,
+                               size_t repeat)
+{
+    if (indicator == nullptr || pattern.empty())
+        return false;
+
+    for (auto & step : pattern)
+    {
+        if (step.duration < s_tick)
+            return false;
+    }
+
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    auto & timer = m_timers[indicator];
+    if (timer)
+        unschedule(timer.get());
+    else
+        timer.reset(new STimer{});
+
+    timer->indicator = indicator;
+    timer->pattern   = pattern;
+    timer->step      = 0;
+    timer->repeat    = repeat;
+    timer->round     = 0;
+
+    // The first step is shown on the next tick.
+    schedule(timer.get(), 0);
+    m_wake.notify_one();
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+// Снять индикатор с планировщика.
+void CIndicatorScheduler::cancel(IIndicator * indicator)
+{
+    std::unique_lock<std::mutex> guard(m_lock);
+
+    auto it = m_timers.find(indicator);
+    if (it != m_timers.end())
+    {
+        unschedule(it->second.get());
+        m_timers.erase(it);
+    }
+
+    // The indicator may be in the batch being sent right now, 
+    // a finished finite pattern too.
+    m_sent.wait(guard, [this] { return !m_sending; });
+}
+
+//=============================================================================
+
+// Поставить таймер через delay шагов.
+void CIndicatorScheduler::schedule(STimer * timer, uint64_t delay)
+{
+    delay = std::max<uint64_t>(delay, 1);
+
+    // The slot comes round every s_slots ticks, longer delays wait laps.
+    timer->slot = (m_tick + delay) & (s_slots - 1);
+    timer->laps = (delay - 1) / s_slots;
+    timer->pos  = m_wheel[timer->slot].insert(m_wheel[timer->slot].end(), timer);
+}
+
+//-----------------------------------------------------------------------------
+
+// Снять таймер с колеса.
+void CIndicatorScheduler::unschedule(STimer * timer)
+{
+    m_wheel[timer->slot].erase(timer->pos);
+}
+
+//-----------------------------------------------------------------------------
+
+// Обработать один шаг колеса.
+void CIndicatorScheduler::advance(std::vector<IIndicator *> & batch)
+{
+    m_tick++;
+
+    auto & slot = m_wheel[m_tick & (s_slots - 1)];
+    for (auto it = slot.begin(); it != slot.end();)
+    {
+        auto timer = *it;
+        if (timer->laps > 0)
+        {
+            timer->laps--;
+            ++it;
+            continue;
+        }
+
+        it = slot.erase(it);
+        m_fired.push_back(timer);
+    }
+
+    // Rescheduled only now: a delay of whole laps lands in this very slot,
+    // and the loop above would meet the timer again.
+    for (auto timer : m_fired)
+    {
+        auto & step = timer->pattern[timer->step];
+        timer->indicator->setColor(step.color);
+        batch.push_back(timer->indicator);
+
+        if (++timer->step == timer->pattern.size())
+        {
+            timer->step = 0;
+            timer->round++;
+
+            // A finite pattern leaves its last color on.
+            if (timer->repeat != 0 && timer->round == timer->repeat)
+            {
+                m_timers.erase(timer->indicator);
+                continue;
+            }
+        }
+
+        schedule(timer, static_cast<uint64_t>(step.duration / s_tick));
+    }
+
+    m_fired.clear();
+}
+
+//-----------------------------------------------------------------------------
+
+// Шагов до ближайшего срабатывания.
+uint64_t CIndicatorScheduler::nextDue() const
+{
+    // Every slot is met once per lap, a timer due later has laps left.
+    for (uint64_t delay = 1; delay <= s_slots; delay++)
+    {
+        for (auto timer : m_wheel[(m_tick + delay) & (s_slots - 1)])
+        {
+            if (timer->laps == 0)
+                return delay;
+        }
+    }
+
+    return s_slots;
+}
+
+//-----------------------------------------------------------------------------
+
+// Цикл потока.
+void CIndicatorScheduler::run()
+{
+    std::vector<IIndicator *> batch;
+    std::unique_lock<std::mutex> guard(m_lock);
+
+    // Time of the current tick, absolute deadlines keep the wheel from drifting.
+    auto deadline = std::chrono::steady_clock::now();
+
+    while (m_running.load())
+    {
+        // Nothing to play: sleep until play() or stop(), the wheel 
+        // resumes from the moment of waking.
+        if (m_timers.empty())
+        {
+            m_wake.wait(guard);
+            deadline = std::chrono::steady_clock::now();
+            continue;
+        }
+
+        // play() may bring the nearest timer closer, then look again.
+        auto due = deadline + nextDue() * s_tick;
+        if (m_wake.wait_until(guard, due) == std::cv_status::no_timeout)
+            continue;
+
+        // Catch up on ticks missed while the thread was delayed.
+        batch.clear();
+        auto now = std::chrono::steady_clock::now();
+        while (deadline + s_tick <= now)
+        {
+            deadline += s_tick;
+            advance(batch);
+        }
+
+        // One send per indicator, however many steps fell due.
+        std::sort(batch.begin(), batch.end());
+        batch.erase(std::unique(batch.begin(), batch.end()), batch.end());
+
+        // Sent without the lock, so play() and cancel() don't wait for 
+        // the driver. cancel() waits for the batch instead.
+        m_sending = true;
+        guard.unlock();
+
+        for (auto indicator : batch)
+            indicator->region().send();
+
+        guard.lock();
+        m_sending = false;
+        m_sent.notify_all();
+    }
+}
+
+//=============================================================================
+
+} // namespace drv
@@ -0,0 +1,118 @@
+#ifndef DRV_CINDICATORSCHEDULER_H
+#define DRV_CINDICATORSCHEDULER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "iindicator.h"
+
+namespace drv
+{
+
+//=============================================================================
+
+// Планировщик анимаций: один поток обслуживает любое число индикаторов.
+// Таймеры хранятся в хэшированном колесе (шаг 1 мс), вставка и
+// срабатывание - O(1). Отправки, выпавшие на один шаг, выполняются пачкой.
+// Поток спит до ближайшего срабатывания, без таймеров - до вызова play().
+class CIndicatorScheduler
+{
+public:
+    // Шаг шаблона: цвет и время его удержания.
+    struct SStep
+    {
+        IIndicator::color_t       color;
+        std::chrono::milliseconds duration;
+    };
+
+    using pattern_t = std::vector<SStep>;
+
+    //-------------------------------------------------------------------------
+
+    CIndicatorScheduler();
+    ~CIndicatorScheduler();
+
+    //-------------------------------------------------------------------------
+
+    // Запустить поток планировщика.
+    void start();
+
+    // Остановить поток планировщика.
+    void stop();
+
+    //-------------------------------------------------------------------------
+
+    // Проиграть шаблон на индикаторе (repeat = 0 - бесконечно).
+    // Предыдущий шаблон индикатора заменяется.
+    bool play(IIndicator * indicator, const pattern_t & pattern, size_t repeat = 0);
+
+    // Снять индикатор с планировщика (дожидается текущей пачки отправок,
+    // после возврата индикатор можно удалять).
+    void cancel(IIndicator * indicator);
+
+private:
+    //-------------------------------------------------------------------------
+
+    // Таймер индикатора.
+    struct STimer
+    {
+        IIndicator * indicator;
+        pattern_t    pattern;
+        size_t       step;          // Следующий шаг шаблона.
+        size_t       repeat;        // Число проходов (0 - бесконечно).
+        size_t       round;         // Завершенные проходы.
+        uint64_t     laps;          // Оставшиеся обороты колеса.
+        size_t       slot;          // Ячейка колеса.
+        std::list<STimer *>::iterator pos;
+    };
+
+    //-------------------------------------------------------------------------
+
+    // Поставить таймер через delay шагов (не раньше следующего шага).
+    void schedule(STimer * timer, uint64_t delay);
+
+    // Снять таймер с колеса.
+    void unschedule(STimer * timer);
+
+    // Обработать один шаг колеса.
+    void advance(std::vector<IIndicator *> & batch);
+
+    // Шагов до ближайшего срабатывания (не больше оборота колеса).
+    uint64_t nextDue() const;
+
+    // Цикл потока.
+    void run();
+
+    //-------------------------------------------------------------------------
+
+    // Количество ячеек колеса (степень двойки) и длительность шага.
+    constexpr static const size_t s_slots = 512U;
+    constexpr static const std::chrono::milliseconds s_tick{1};
+
+    //-------------------------------------------------------------------------
+
+    std::array<std::list<STimer *>, s_slots> m_wheel;
+    std::unordered_map<IIndicator *, std::unique_ptr<STimer>> m_timers;
+    std::vector<STimer *> m_fired;  // Сработавшие на текущем шаге.
+    uint64_t          m_tick;       // Номер текущего шага.
+    std::mutex        m_lock;
+    std::condition_variable m_wake; // Расписание изменилось или остановка.
+    std::condition_variable m_sent; // Пачка отправлена.
+    bool              m_sending;    // Пачка отправляется без m_lock.
+    std::thread       m_thread;
+    std::atomic<bool> m_running;
+};
+
+//=============================================================================
+
+} // namespace drv
+
+#endif // DRV_CINDICATORSCHEDULER_H
@@ -0,0 +1,131 @@
+#include "cindicatortransaction.h"
+#include "indicatorregmap.h"
+
+#include <algorithm>
+
+namespace drv
+{
+
+//=============================================================================
+
+CIndicatorTransaction::CIndicatorTransaction(ILockableIndicator & indicator)
+    : m_indicator{&indicator}, m_regs{nullptr}, m_count{0}, m_dirty{0},
+      m_saved{}, m_active{true}
+{
+    auto mem = m_indicator->region().getIntMemIO();
+
+    m_indicator->lockRegion();
+    m_regs  = static_cast<uint32_t *>(mem->getData());
+    m_count = std::min(mem->getSize() / sizeof(uint32_t), s_maxRegs);
+}
+
+CIndicatorTransaction::~CIndicatorTransaction()
+{
+    if (m_active)
+        commit();
+}
+
+//=============================================================================
+
+// Прочитать регистр локального региона.
+uint32_t CIndicatorTransaction::getReg(size_t offset) const
+{
+    auto index = offset / sizeof(uint32_t);
+    if (!m_active || index >= m_count)
+        return 0x00U;
+
+    return m_regs[index];
+}
+
+//-----------------------------------------------------------------------------
+
+// Записать регистр.
+void CIndicatorTransaction::setReg(size_t offset, uint32_t value)
+{
+    auto index = offset / sizeof(uint32_t);
+    if (!m_active || index >= m_count || m_regs[index] == value)
+        return;
+
+    auto bit = uint64_t{1} << index;
+    if (!(m_dirty & bit))
+    {
+        m_saved[index] = m_regs[index];
+        m_dirty |= bit;
+    }
+
+    m_regs[index] = value;
+}
+
+//-----------------------------------------------------------------------------
+
+// Заменить биты регистра по маске.
+void CIndicatorTransaction::modify(size_t offset, uint32_t mask, uint32_t value)
+{
+    setReg(offset, (getReg(offset) & ~mask) | (value & mask));
+}
+
+//=============================================================================
+
+// Запросить цвет.
+IIndicator::color_t CIndicatorTransaction::getColor() const
+{
+    using color = regmap::indicator::color;
+    return color::decode(getReg(color::offset));
+}
+
+//-----------------------------------------------------------------------------
+
+// Задать цвет.
+void CIndicatorTransaction::setColor(IIndicator::color_t type)
+{
+    using color = regmap::indicator::color;
+    setReg(color::offset, color::insert(getReg(color::offset), type));
+}
+
+//=============================================================================
+
+// Завершить транзакцию.
+bool CIndicatorTransaction::commit()
+{
+    if (!m_active)
+        return false;
+
+    m_active = false;
+
+    // Values written back to what they were don't count.
+    for (size_t i = 0; i < m_count; i++)
+    {
+        if ((m_dirty >> i) & 0x01U && m_regs[i] == m_saved[i])
+            m_dirty &= ~(uint64_t{1} << i);
+    }
+
+    auto dirty = m_dirty != 0;
+    m_indicator->unlockRegion();
+
+    // The device is not touched with the region locked.
+    return dirty ? m_indicator->region().send() : true;
+}
+
+//-----------------------------------------------------------------------------
+
+// Отменить изменения.
+void CIndicatorTransaction::rollback()
+{
+    if (!m_active)
+        return;
+
+    m_active = false;
+
+    for (size_t i = 0; i < m_count; i++)
+    {
+        if ((m_dirty >> i) & 0x01U)
+            m_regs[i] = m_saved[i];
+    }
+
+    m_dirty = 0;
+    m_indicator->unlockRegion();
+}
+
+//=============================================================================
+
+} // namespace drv
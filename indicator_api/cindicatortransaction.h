@@ -0,0 +1,79 @@
+#ifndef DRV_CINDICATORTRANSACTION_H
+#define DRV_CINDICATORTRANSACTION_H
+
+#include <array>
+#include <cstdint>
+
+#include "ilockableindicator.h"
+
+namespace drv
+{
+
+//=============================================================================
+
+// Транзакция над локальным регионом индикатора (RAII).
+// Регион захватывается один раз на всю транзакцию, измененные регистры
+// отмечаются. commit() освобождает регион и отправляет его одним
+// обращением к устройству, только если что-то изменилось.
+// Деструктор выполняет commit(), если не было commit() или rollback().
+// CThrottledIndicator не подходит: его поток записи затер бы транзакцию.
+class CIndicatorTransaction
+{
+public:
+    explicit CIndicatorTransaction(ILockableIndicator & indicator);
+    ~CIndicatorTransaction();
+
+    CIndicatorTransaction(const CIndicatorTransaction &) = delete;
+    CIndicatorTransaction & operator=(const CIndicatorTransaction &) = delete;
+
+    //-------------------------------------------------------------------------
+
+    // Прочитать регистр локального региона.
+    uint32_t getReg(size_t offset) const;
+
+    // Записать регистр.
+    void setReg(size_t offset, uint32_t value);
+
+    // Заменить биты регистра по маске.
+    void modify(size_t offset, uint32_t mask, uint32_t value);
+
+    //-------------------------------------------------------------------------
+
+    // Запросить цвет.
+    IIndicator::color_t getColor() const;
+
+    // Задать цвет.
+    void setColor(IIndicator::color_t type);
+
+    //-------------------------------------------------------------------------
+
+    // Проверить, изменен ли регион.
+    bool isDirty() const { return m_dirty != 0; }
+
+    // Завершить транзакцию (false - отправка не удалась).
+    bool commit();
+
+    // Отменить изменения и завершить транзакцию без отправки.
+    void rollback();
+
+private:
+    //-------------------------------------------------------------------------
+
+    // Наибольшее количество регистров (по биту на регистр в m_dirty).
+    constexpr static const size_t s_maxRegs = 64U;
+
+    //-------------------------------------------------------------------------
+
+    ILockableIndicator * m_indicator;
+    uint32_t   * m_regs;                        // Локальный регион.
+    size_t       m_count;                       // Количество регистров.
+    uint64_t     m_dirty;                       // Измененные регистры.
+    std::array<uint32_t, s_maxRegs> m_saved;    // Исходные значения.
+    bool         m_active;
+};
+
+//=============================================================================
+
+} // namespace drv
+
+#endif // DRV_CINDICATORTRANSACTION_H
@@ -0,0 +1,139 @@
+#ifndef DRV_CSTATICINDICATOR_H
+#define DRV_CSTATICINDICATOR_H
+
+#include "indicatorregmap.h"
+#include "device-library/cdrvreg.h"
+
+namespace drv
+{
+
+using namespace api::dev;
+using namespace dev::drv;
+
+//=============================================================================
+
+// Индикатор со статической диспетчеризацией (CRTP) для горячих циклов.
+// Derived предоставляет load(index) / store(index, value) / modify(...),
+// где index - номер регистра (как у lReg() в CIndicator).
+// Для плагинов остается виртуальный CIndicator.
+template<typename Derived>
+class CStaticIndicator
+{
+public:
+    using color_t = IIndicator::color_t;
+    using color   = regmap::indicator::color;
+
+    //-------------------------------------------------------------------------
+
+    // Запросить цвет.
+    color_t getColor() { return get<color>(); }
+
+    // Задать цвет.
+    void setColor(color_t type) { set<color>(type); }
+
+    // Задать цвет, известный на этапе компиляции.
+    template<color_t Type>
+    void setColor() { self().store(color::index, color::template encode<Type>()); }
+
+    //-------------------------------------------------------------------------
+
+    // Прочитать поле.
+    template<typename F>
+    typename F::value_type get()
+    {
+        return F::decode(self().load(F::index));
+    }
+
+    // Записать поле.
+    template<typename F>
+    void set(typename F::value_type value)
+    {
+        if (F::exclusive)
+            self().store(F::index, F::encode(value));
+        else
+            self().modify(F::index, F::mask, F::encode(value));
+    }
+
+private:
+    //-------------------------------------------------------------------------
+
+    Derived & self() { return static_cast<Derived &>(*this); }
+};
+
+//=============================================================================
+
+// Статический индикатор поверх окна регистров, отображенного mmap().
+// Запись поля - одна некэшируемая запись в память.
+class CStaticIndicatorMap : public CStaticIndicator<CStaticIndicatorMap>
+{
+public:
+    explicit CStaticIndicatorMap(volatile uint32_t * regs) : m_regs{regs} {}
+
+    //-------------------------------------------------------------------------
+
+    uint32_t load(size_t index) const
+    {
+        return m_regs[index];
+    }
+
+    void store(size_t index, uint32_t value)
+    {
+        m_regs[index] = value;
+    }
+
+    void modify(size_t index, uint32_t mask, uint32_t bits)
+    {
+        auto & reg = m_regs[index];
+        reg = (reg & ~mask) | bits;
+    }
+
+private:
+    volatile uint32_t * m_regs;     // Начало окна регистров.
+};
+
+//=============================================================================
+
+// Статический индикатор поверх локального региона (отправка - region().send()).
+class CStaticIndicatorRegion : public CDriverRegion,
+                               public CStaticIndicator<CStaticIndicatorRegion>
+{
+public:
+    CStaticIndicatorRegion() : CDriverRegion{regmap::indicator::regs} {}
+
+    //-------------------------------------------------------------------------
+
+    uint32_t load(size_t index)
+    {
+        lock();
+        auto value = lReg<uint32_t>(index);
+        unlock();
+
+        return value;
+    }
+
+    void store(size_t index, uint32_t value)
+    {
+        lock();
+        lReg<uint32_t>(index) = value;
+        unlock();
+    }
+
+    void modify(size_t index, uint32_t mask, uint32_t bits)
+    {
+        lock();
+        auto & reg = lReg<uint32_t>(index);
+        reg = (reg & ~mask) | bits;
+        unlock();
+    }
+
+    //-------------------------------------------------------------------------
+
+    // Запросить интерфейс региона.
+    IDriverRegion & region() { return CDriverRegion::region(); }
+};
+
+//=============================================================================
+
+} // namespace drv
+
+#endif // DRV_CSTATICINDICATOR_H
@@ -0,0 +1,130 @@
+#include "cthrottledindicator.h"
+#include "indicatorregmap.h"
+
+namespace drv
+{
+
+//=============================================================================
+
+constexpr const uint32_t CThrottledIndicator::s_dirty;
+constexpr const uint32_t CThrottledIndicator::s_idle;
+constexpr const uint32_t CThrottledIndicator::s_color;
+constexpr const size_t CThrottledIndicator::s_regs;
+
+CThrottledIndicator::CThrottledIndicator(IIndicator * target,
+                                         std::chrono::microseconds interval)
+    : CDriverRegion{s_regs}, m_target{target}, m_interval{interval}, m_slot{0},
+      m_commits{0}, m_running{true}
+{
+    setDevIO(this);
+    m_slot.store(static_cast<uint32_t>(m_target->getColor()) & s_color);
+    m_thread = std::thread(&CThrottledIndicator::run, this);
+}
+
+CThrottledIndicator::~CThrottledIndicator()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_running.store(false);
+    }
+
+    m_wake.notify_one();
+    m_thread.join();
+}
+
+//=============================================================================
+
+// Запросить цвет.
+IIndicator::color_t CThrottledIndicator::getColor()
+{
+    return static_cast<color_t>(m_slot.load(std::memory_order_relaxed) & s_color);
+}
+
+//-----------------------------------------------------------------------------
+
+// Задать цвет.
+void CThrottledIndicator::setColor(const color_t & type)
+{
+    auto value = (static_cast<uint32_t>(type) & s_color) | s_dirty;
+
+    // Storing clears s_idle; only then does the producer pay for a wakeup.
+    if (m_slot.exchange(value, std::memory_order_release) & s_idle)
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_wake.notify_one();
+    }
+}
+
+//=============================================================================
+
+// Прочитать регион.
+bool CThrottledIndicator::devRead()
+{
+    using color = regmap::indicator::color;
+
+    auto data = static_cast<uint32_t *>(getIntMemIO()->getData());
+    data[color::index] = color::insert(data[color::index], getColor());
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+// Передать регион.
+bool CThrottledIndicator::devWrite()
+{
+    // setColor() has already put the color into the slot, the thread
+    // writes it to the target no more often than the interval allows.
+    return true;
+}
+
+//=============================================================================
+
+// Цикл потока записи.
+void CThrottledIndicator::run()
+{
+    auto next = std::chrono::steady_clock::now();
+
+    while (true)
+    {
+        auto value = m_slot.load(std::memory_order_acquire);
+
+        if (value & s_dirty)
+        {
+            // Leading edge goes out at once, the rest waits for the interval.
+            std::this_thread::sleep_until(next);
+
+            value = m_slot.fetch_and(~s_dirty, std::memory_order_acquire);
+            commit(value & s_color);
+            next = std::chrono::steady_clock::now() + m_interval;
+            continue;
+        }
+
+        // The final value has landed; stopping is safe now.
+        if (!m_running.load())
+            break;
+
+        if (!m_slot.compare_exchange_weak(value, value | s_idle))
+            continue;
+
+        std::unique_lock<std::mutex> guard(m_lock);
+        m_wake.wait(guard, [this] {
+            return !(m_slot.load() & s_idle) || !m_running.load();
+        });
+        m_slot.fetch_and(~s_idle);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+// Записать цвет в индикатор.
+void CThrottledIndicator::commit(uint32_t color)
+{
+    m_target->setColor(static_cast<color_t>(color));
+    m_target->region().send();
+    m_commits++;
+}
+
+//=============================================================================
+
+} // namespace drv
@@ -0,0 +1,97 @@
+#ifndef DRV_CTHROTTLEDINDICATOR_H
+#define DRV_CTHROTTLEDINDICATOR_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "iindicator.h"
+#include "device-library/cdrvreg.h"
+
+namespace drv
+{
+
+using namespace api::dev;
+using namespace dev::drv;
+
+//=============================================================================
+
+// Индикатор с ограничением частоты записи.
+// setColor() сохраняет цвет в атомарной ячейке последнего значения,
+// отдельный поток записывает его в индикатор не чаще раза за интервал.
+// Промежуточные цвета пропускаются, последний записывается всегда.
+// Собственный регион не дает обойти ограничение: send() не пишет в
+// индикатор в обход потока записи, recv() возвращает последний цвет.
+class CThrottledIndicator : public CDriverRegion, public IIndicator, public IDevIO
+{
+public:
+    explicit CThrottledIndicator(IIndicator * target,
+                                 std::chrono::microseconds interval = std::chrono::milliseconds(10));
+    ~CThrottledIndicator() override;
+
+    //-------------------------------------------------------------------------
+
+    // Запросить цвет (последний заданный).
+    color_t getColor() override;
+
+    //-------------------------------------------------------------------------
+
+    // Задать цвет (одна атомарная операция).
+    void setColor(const color_t & type) override;
+
+    //-------------------------------------------------------------------------
+
+    // Запросить интерфейс региона (не регион индикатора-получателя).
+    IDriverRegion & region() override { return CDriverRegion::region(); }
+
+    //-------------------------------------------------------------------------
+
+    // Прочитать регион: последний заданный цвет.
+    bool devRead() override;
+
+    // Передать регион: цвет уже в ячейке, записью занят поток.
+    bool devWrite() override;
+
+    //-------------------------------------------------------------------------
+
+    // Количество записей в индикатор.
+    uint64_t getCommits() const { return m_commits.load(); }
+
+private:
+    //-------------------------------------------------------------------------
+
+    // Цикл потока записи.
+    void run();
+
+    // Записать цвет в индикатор.
+    void commit(uint32_t color);
+
+    //-------------------------------------------------------------------------
+
+    // Биты ячейки: новое значение и ожидание потока записи.
+    constexpr static const uint32_t s_dirty = 0x80000000U;
+    constexpr static const uint32_t s_idle  = 0x40000000U;
+    constexpr static const uint32_t s_color = 0x0000FFFFU;
+
+    // Количество регистров (как у CIndicator).
+    constexpr static const size_t s_regs = 0x01U;
+
+    //-------------------------------------------------------------------------
+
+    IIndicator * m_target;                  // Индикатор.
+    std::chrono::microseconds m_interval;   // Минимальный интервал записи.
+    std::atomic<uint32_t> m_slot;           // Последний цвет и флаги.
+    std::atomic<uint64_t> m_commits;
+    std::atomic<bool> m_running;
+    std::mutex m_lock;                      // Только для сна потока.
+    std::condition_variable m_wake;
+    std::thread m_thread;
+};
+
+//=============================================================================
+
+} // namespace drv
+
+#endif // DRV_CTHROTTLEDINDICATOR_H
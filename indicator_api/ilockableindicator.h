@@ -0,0 +1,31 @@
+#ifndef DRV_ILOCKABLEINDICATOR_H
+#define DRV_ILOCKABLEINDICATOR_H
+
+#include "iindicator.h"
+
+namespace drv
+{
+
+//=============================================================================
+
+// Индикатор, локальный регион которого можно захватить извне
+// (для CIndicatorTransaction). IIndicator остается без изменений,
+// чтобы не нарушить ABI плагинов.
+class ILockableIndicator : public IIndicator
+{
+public:
+    ILockableIndicator() = default;
+    ~ILockableIndicator() override = default;
+
+    //-------------------------------------------------------------------------
+
+    // Захватить и освободить локальный регион.
+    virtual void lockRegion() = 0;
+    virtual void unlockRegion() = 0;
+};
+
+//=============================================================================
+
+} // namespace drv
+
+#endif // DRV_ILOCKABLEINDICATOR_H
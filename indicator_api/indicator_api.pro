@@ -10,14 +10,37 @@ INCLUDEPATH += $$_PRO_FILE_PWD_/ \
                $$_PRO_FILE_PWD_/../../
 LIBS += -L$$_PRO_FILE_PWD_/ \
         -L$$_PRO_FILE_PWD_/../../libs/ \
-        -lapi
+        -lapi \
+        -lrt
 DEPENDPATH += $$PWD/
 
 SOURCES += \
         cindicator.cpp \
+        cindicatormap.cpp \
+        cdevsim.cpp \
+        cindicatorscheduler.cpp \
+        cdevshm.cpp \
+        cindicatorcompositor.cpp \
+        cthrottledindicator.cpp \
+        cindicatorio.cpp \
+        cindicatortransaction.cpp \
+        cindicatorreactor.cpp \
 
 HEADERS += \
     cindicator.h \
+    cindicatormap.h \
+    cstaticindicator.h \
+    indicatorregmap.h \
+    cdevsim.h \
+    cindicatorscheduler.h \
+    cdevshm.h \
+    indicatordshm.h \
+    cindicatorcompositor.h \
+    cthrottledindicator.h \
+    cindicatorio.h \
+    cindicatortransaction.h \
+    cindicatorreactor.h \
+    ilockableindicator.h \
     iindicator.h
 
 DESTDIR = $$_PRO_FILE_PWD_/../../libs/
@@ -7,15 +7,37 @@ CONFIG -= app_bundle
 CONFIG -= qt
 
 INCLUDEPATH += $$_PRO_FILE_PWD_/ $$_PRO_FILE_PWD_/../
-LIBS += -L$$_PRO_FILE_PWD_/ -L$$_PRO_FILE_PWD_/../libs/ -lapi -ldevice
+LIBS += -L$$_PRO_FILE_PWD_/ -L$$_PRO_FILE_PWD_/../libs/ -lapi -ldevice -lrt
 DEPENDPATH += $$PWD/
 
 SOURCES += \
         cindicator.cpp \
+        cindicatormap.cpp \
+        cdevsim.cpp \
+        cindicatorscheduler.cpp \
+        cdevshm.cpp \
+        cindicatorcompositor.cpp \
+        cthrottledindicator.cpp \
+        cindicatorio.cpp \
+        cindicatortransaction.cpp \
+        cindicatorreactor.cpp \
         testing_program.cpp
 
 HEADERS += \
     cindicator.h \
+    cindicatormap.h \
+    cstaticindicator.h \
+    indicatorregmap.h \
+    cdevsim.h \
+    cindicatorscheduler.h \
+    cdevshm.h \
+    indicatordshm.h \
+    cindicatorcompositor.h \
+    cthrottledindicator.h \
+    cindicatorio.h \
+    cindicatortransaction.h \
+    cindicatorreactor.h \
+    ilockableindicator.h \
     iindicator.h
 
 DESTDIR = $$_PRO_FILE_PWD_/../
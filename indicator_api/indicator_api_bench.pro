@@ -0,0 +1,30 @@
+TEMPLATE = app
+
+TARGET = indicator_bench
+
+CONFIG += console c++11 c++14 c++17 thread
+CONFIG -= app_bundle
+CONFIG -= qt
+
+INCLUDEPATH += $$_PRO_FILE_PWD_/ $$_PRO_FILE_PWD_/../
+LIBS += -L$$_PRO_FILE_PWD_/ -L$$_PRO_FILE_PWD_/../libs/ -lapi -ldevice -lpthread
+DEPENDPATH += $$PWD/
+
+SOURCES += \
+        cindicator.cpp \
+        cindicatormap.cpp \
+        cdevsim.cpp \
+        benchmark_program.cpp
+
+HEADERS += \
+    cindicator.h \
+    cindicatormap.h \
+    cstaticindicator.h \
+    indicatorregmap.h \
+    cdevsim.h \
+    ilockableindicator.h \
+    iindicator.h
+
+DESTDIR = $$_PRO_FILE_PWD_/../
+target.path = $$DESTDIR
+!isEmpty(target.path): INSTALLS += target
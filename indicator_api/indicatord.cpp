@@ -0,0 +1,338 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "cindicator.h"
+#include "cdevsim.h"
+#include "device-library/cdevsym.h"
+#include "indicatordshm.h"
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+// Демон indicatord: единственный владелец устройств.
+// Клиенты (dev::shm::CDevShm) публикуют запросы в кольцо общей памяти,
+// демон применяет их, объединяя запросы к одному устройству.
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+
+// Устройство демона.
+struct SDevice
+{
+    std::unique_ptr<drv::CIndicator>     indicator;
+    std::unique_ptr<dev::sym::CDevSym>   sym;
+    std::unique_ptr<dev::sim::CDevSim>   sim;
+    drv::shm::SRequest                   pending;
+    bool                                 dirty = false;
+};
+
+volatile sig_atomic_t s_running = 1;
+
+// Права на общую память: демон и клиенты его группы.
+constexpr const mode_t s_mode = 0660;
+
+//-----------------------------------------------------------------------------
+
+void stopHandler(int) { s_running = 0; }
+
+//-----------------------------------------------------------------------------
+
+void usage(const char * name)
+{
+    std::cout << "Usage: " << name << " [-n shm-name] (--sim count | device...)" << std::endl
+              << "  -n     shared memory name (default " << drv::shm::s_name << ")" << std::endl
+              << "  --sim  serve count in-memory devices instead of the driver" << std::endl;
+}
+
+//-----------------------------------------------------------------------------
+
+// Открыть устройство драйвера.
+bool openDevice(SDevice & dev, const std::string & path)
+{
+    dev.indicator.reset(new drv::CIndicator());
+    dev.sym.reset(new dev::sym::CDevSym());
+
+    dev::sym::IDevSym * sym = dev.sym.get();
+    sym->setDevPath(path);
+    sym->setMaxSize(dev.indicator->region().getSize());
+    if (!sym->devOpen())
+        return false;
+
+    dev.sym->setMemIO(dev.indicator->region().getIntMemIO());
+    dev.indicator->region().setDevIO(dev.sym->getIntDevIO());
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+// Создать имитацию устройства.
+void openSim(SDevice & dev)
+{
+    dev.indicator.reset(new drv::CIndicator());
+    dev.sim.reset(new dev::sim::CDevSim());
+
+    dev.sim->setMemIO(dev.indicator->region().getIntMemIO());
+    dev.indicator->region().setDevIO(dev.sim->getIntDevIO());
+}
+
+//-----------------------------------------------------------------------------
+
+// Применить запрос и опубликовать результат.
+void apply(drv::shm::SShared * shared, uint32_t index, SDevice & dev)
+{
+    auto & region = dev.indicator->region();
+    auto count = std::min<size_t>(dev.pending.count, region.getSize() / sizeof(uint32_t));
+
+    dev.indicator->lock();
+    std::memcpy(region.getIntMemIO()->getData(), dev.pending.regs, count * sizeof(uint32_t));
+    dev.indicator->unlock();
+
+    if (!region.send() || !region.recv())
+        std::cerr << "indicatord: device " << index << " update failed" << std::endl;
+
+    dev.indicator->lock();
+    auto data = static_cast<const uint32_t *>(region.getIntMemIO()->getData());
+    for (size_t i = 0; i < count; i++)
+        shared->regs[index][i].store(data[i], std::memory_order_release);
+    dev.indicator->unlock();
+
+    // Clients waiting to read their own write switch to the applied values.
+    shared->applied[index].store(dev.pending.seq, std::memory_order_release);
+}
+
+//-----------------------------------------------------------------------------
+
+// Создать общую память (-1 - ошибка или демон с этим именем уже работает).
+int createShared(const std::string & name)
+{
+    // A crashed daemon leaves its segment behind; a live one keeps it.
+    auto fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd >= 0)
+    {
+        auto addr = mmap(nullptr, sizeof(drv::shm::SShared), PROT_READ | PROT_WRITE,
+                         MAP_SHARED, fd, 0);
+        close(fd);
+
+        if (addr != MAP_FAILED)
+        {
+            auto old  = static_cast<drv::shm::SShared *>(addr);
+            auto live = old->magic.load(std::memory_order_acquire) == drv::shm::s_magic &&
+                        kill(old->pid, 0) == 0;
+
+            // Clients still mapping the old segment stop using it at once.
+            if (!live)
+                old->magic.store(0, std::memory_order_release);
+
+            munmap(addr, sizeof(drv::shm::SShared));
+
+            if (live)
+            {
+                errno = EEXIST;
+                return -1;
+            }
+        }
+
+        shm_unlink(name.c_str());
+    }
+
+    fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, s_mode);
+    if (fd < 0)
+        return -1;
+
+    // shm_open() applies the umask, the group still needs write access.
+    if (fchmod(fd, s_mode) != 0 || ftruncate(fd, sizeof(drv::shm::SShared)) != 0)
+    {
+        close(fd);
+        shm_unlink(name.c_str());
+        return -1;
+    }
+
+    return fd;
+}
+
+//-----------------------------------------------------------------------------
+
+// Дождаться запросов (false - кольцо пусто).
+bool waitRequests(drv::shm::SShared * shared, drv::shm::SRequest & req)
+{
+    // Clients take a daemon without a fresh beat for a dead one.
+    drv::shm::beat(shared);
+
+    // A short spin keeps bursts off the futex.
+    for (int i = 0; i < 1000; i++)
+    {
+        if (drv::shm::pop(shared, req))
+            return true;
+    }
+
+    shared->idle.store(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (drv::shm::pop(shared, req))
+    {
+        shared->idle.store(0);
+        return true;
+    }
+
+    // Bounded sleep so that stop signals are noticed and beats stay fresh.
+    timespec timeout{0, 100 * 1000 * 1000};
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&shared->idle),
+            FUTEX_WAIT, 1, &timeout, nullptr, 0);
+    shared->idle.store(0);
+
+    return drv::shm::pop(shared, req);
+}
+
+//-----------------------------------------------------------------------------
+
+} // namespace
+
+int main(int argc, char * argv[])
+{
+    std::string name = drv::shm::s_name;
+    std::vector<SDevice> devices;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+
+        if (arg == "-n" && i + 1 < argc)
+        {
+            name = argv[++i];
+        }
+        else if (arg == "--sim" && i + 1 < argc)
+        {
+            auto count = std::stoul(argv[++i]);
+            for (size_t j = 0; j < count; j++)
+            {
+                devices.emplace_back();
+                openSim(devices.back());
+            }
+        }
+        else if (arg == "-h" || arg == "--help")
+        {
+            usage(argv[0]);
+            return EXIT_SUCCESS;
+        }
+        else
+        {
+            devices.emplace_back();
+            if (!openDevice(devices.back(), arg))
+            {
+                std::cerr << "indicatord: can't open " << arg << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    if (devices.empty() || devices.size() > drv::shm::s_maxDevices)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    for (auto & dev : devices)
+    {
+        if (dev.indicator->region().getSize() > drv::shm::s_maxRegs * sizeof(uint32_t))
+        {
+            std::cerr << "indicatord: region too large" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    //-------------------------------------------------------------------------
+
+    auto fd = createShared(name);
+    if (fd < 0)
+    {
+        std::cerr << "indicatord: can't create " << name << ": " << strerror(errno) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    auto addr = mmap(nullptr, sizeof(drv::shm::SShared), PROT_READ | PROT_WRITE,
+                     MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (addr == MAP_FAILED)
+    {
+        shm_unlink(name.c_str());
+        return EXIT_FAILURE;
+    }
+
+    auto shared = new (addr) drv::shm::SShared;
+
+    // Publish the current device state before clients can attach.
+    for (uint32_t i = 0; i < devices.size(); i++)
+    {
+        auto & region = devices[i].indicator->region();
+        if (!region.recv())
+            continue;
+
+        auto data = static_cast<const uint32_t *>(region.getIntMemIO()->getData());
+        for (size_t j = 0; j < region.getSize() / sizeof(uint32_t); j++)
+            shared->regs[i][j].store(data[j], std::memory_order_relaxed);
+    }
+
+    shared->pid = getpid();
+    drv::shm::init(shared, static_cast<uint32_t>(devices.size()));
+
+    signal(SIGINT, stopHandler);
+    signal(SIGTERM, stopHandler);
+
+    //-------------------------------------------------------------------------
+
+    drv::shm::SRequest req;
+    while (s_running)
+    {
+        if (!waitRequests(shared, req))
+            continue;
+
+        // Drain whatever is queued; only the last request per device matters.
+        do
+        {
+            if (req.device >= devices.size())
+                continue;
+
+            devices[req.device].pending = req;
+            devices[req.device].dirty   = true;
+        } while (drv::shm::pop(shared, req));
+
+        for (uint32_t i = 0; i < devices.size(); i++)
+        {
+            if (!devices[i].dirty)
+                continue;
+
+            devices[i].dirty = false;
+            apply(shared, i, devices[i]);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+
+    shared->magic.store(0, std::memory_order_release);
+    munmap(addr, sizeof(drv::shm::SShared));
+    shm_unlink(name.c_str());
+
+    for (auto & dev : devices)
+    {
+        if (dev.sym)
+            dev.sym->devClose();
+    }
+
+    return EXIT_SUCCESS;
+}
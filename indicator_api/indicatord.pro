@@ -0,0 +1,27 @@
+TEMPLATE = app
+
+TARGET = indicatord
+
+CONFIG += console c++11 c++14 c++17 thread
+CONFIG -= app_bundle
+CONFIG -= qt
+
+INCLUDEPATH += $$_PRO_FILE_PWD_/ $$_PRO_FILE_PWD_/../
+LIBS += -L$$_PRO_FILE_PWD_/ -L$$_PRO_FILE_PWD_/../libs/ -lapi -ldevice -lrt
+DEPENDPATH += $$PWD/
+
+SOURCES += \
+        cindicator.cpp \
+        cdevsim.cpp \
+        indicatord.cpp
+
+HEADERS += \
+    cindicator.h \
+    cdevsim.h \
+    indicatordshm.h \
+    ilockableindicator.h \
+    iindicator.h
+
+DESTDIR = $$_PRO_FILE_PWD_/../
+target.path = $$DESTDIR
+!isEmpty(target.path): INSTALLS += target
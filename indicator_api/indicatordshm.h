@@ -0,0 +1,212 @@
+#ifndef DRV_INDICATORDSHM_H
+#define DRV_INDICATORDSHM_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace drv
+{
+namespace shm
+{
+
+//=============================================================================
+
+// Общая память демона indicatord и его клиентов.
+// Клиент, завершившийся между захватом ячейки и ее публикацией в push(),
+// останавливает кольцо: запросы за этой ячейкой не выдаются, пока демон
+// не будет перезапущен.
+
+//-----------------------------------------------------------------------------
+
+// Имя объекта разделяемой памяти по умолчанию.
+constexpr static const char * s_name = "/indicatord";
+
+// Признак инициализированной памяти.
+constexpr static const uint32_t s_magic = 0x494E4431U;
+
+// Размер кольца (степень двойки), число устройств и регистров.
+constexpr static const size_t s_ringSize   = 1024U;
+constexpr static const size_t s_maxDevices = 16U;
+constexpr static const size_t s_maxRegs    = 4U;
+
+// Демон без отметки дольше этого считается завершенным.
+constexpr static const std::chrono::seconds s_beatTimeout{1};
+
+//-----------------------------------------------------------------------------
+
+// Запрос клиента: новое содержимое региона устройства.
+struct SRequest
+{
+    uint64_t seq;               // Номер запроса (заполняет push()).
+    uint32_t device;
+    uint32_t count;
+    uint32_t regs[s_maxRegs];
+};
+
+// Ячейка кольца.
+struct alignas(64) SCell
+{
+    std::atomic<uint64_t> seq;
+    SRequest              req;
+};
+
+//-----------------------------------------------------------------------------
+
+// Разметка разделяемой памяти.
+struct SShared
+{
+    std::atomic<uint32_t> magic;
+    uint32_t              devices;
+    int32_t               pid;          // Процесс демона.
+
+    // Daemon's last pass over the ring, steady clock in ns.
+    alignas(64) std::atomic<uint64_t> beat;
+
+    // Enqueue and dequeue positions live on separate cache lines.
+    alignas(64) std::atomic<uint64_t> head;
+    alignas(64) std::atomic<uint64_t> tail;
+
+    // Set while the daemon sleeps; a client that clears it wakes the daemon.
+    alignas(64) std::atomic<uint32_t> idle;
+
+    // Register values last applied by the daemon.
+    alignas(64) std::atomic<uint32_t> regs[s_maxDevices][s_maxRegs];
+
+    // Seq of the last request applied to each device, published after regs.
+    alignas(64) std::atomic<uint64_t> applied[s_maxDevices];
+
+    SCell cells[s_ringSize];
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared ring needs lock-free atomics");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "shared ring needs lock-free atomics");
+static_assert((s_ringSize & (s_ringSize - 1)) == 0, "ring size must be a power of two");
+
+//=============================================================================
+
+// Текущее время для отметки демона (нс, общие для всех процессов часы).
+inline uint64_t now()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+//-----------------------------------------------------------------------------
+
+// Отметиться (вызывает демон при каждом проходе по кольцу).
+inline void beat(SShared * shared)
+{
+    shared->beat.store(now(), std::memory_order_relaxed);
+}
+
+//-----------------------------------------------------------------------------
+
+// Проверить, обслуживает ли демон эту память: magic снимается при
+// завершении демона и его преемником, отметка устаревает при аварии.
+inline bool alive(const SShared * shared)
+{
+    if (shared->magic.load(std::memory_order_acquire) != s_magic)
+        return false;
+
+    auto age = static_cast<int64_t>(now() - shared->beat.load(std::memory_order_relaxed));
+    return age < std::chrono::duration_cast<std::chrono::nanoseconds>(s_beatTimeout).count();
+}
+
+//-----------------------------------------------------------------------------
+
+// Подготовить кольцо (вызывает демон до публикации magic).
+// Значения регистров демон заполняет заранее.
+inline void init(SShared * shared, uint32_t devices)
+{
+    shared->devices = devices;
+    shared->head.store(0, std::memory_order_relaxed);
+    shared->tail.store(0, std::memory_order_relaxed);
+    shared->idle.store(0, std::memory_order_relaxed);
+    beat(shared);
+
+    for (size_t i = 0; i < s_maxDevices; i++)
+        shared->applied[i].store(0, std::memory_order_relaxed);
+
+    for (size_t i = 0; i < s_ringSize; i++)
+        shared->cells[i].seq.store(i, std::memory_order_relaxed);
+
+    shared->magic.store(s_magic, std::memory_order_release);
+}
+
+//-----------------------------------------------------------------------------
+
+// Поместить запрос в кольцо и вернуть его номер (0 - кольцо заполнено).
+inline uint64_t push(SShared * shared, const SRequest & req)
+{
+    auto pos = shared->head.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+        auto & cell = shared->cells[pos & (s_ringSize - 1)];
+        auto seq = cell.seq.load(std::memory_order_acquire);
+        auto dif = static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+
+        if (dif == 0)
+        {
+            if (shared->head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                cell.req     = req;
+                cell.req.seq = pos + 1;
+
+                // Nobody touches the cell until it is published.
+                cell.seq.store(pos + 1, std::memory_order_release);
+                return pos + 1;
+            }
+        }
+        else if (dif < 0)
+        {
+            return 0;
+        }
+        else
+        {
+            pos = shared->head.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+// Извлечь запрос из кольца (false - кольцо пусто).
+inline bool pop(SShared * shared, SRequest & req)
+{
+    auto pos = shared->tail.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+        auto & cell = shared->cells[pos & (s_ringSize - 1)];
+        auto seq = cell.seq.load(std::memory_order_acquire);
+        auto dif = static_cast<int64_t>(seq) - static_cast<int64_t>(pos + 1);
+
+        if (dif == 0)
+        {
+            if (shared->tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                req = cell.req;
+                cell.seq.store(pos + s_ringSize, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (dif < 0)
+        {
+            return false;
+        }
+        else
+        {
+            pos = shared->tail.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+//=============================================================================
+
+} // namespace shm
+} // namespace drv
+
+#endif // DRV_INDICATORDSHM_H
@@ -0,0 +1,105 @@
+#ifndef DRV_INDICATORREGMAP_H
+#define DRV_INDICATORREGMAP_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "iindicator.h"
+
+namespace drv
+{
+namespace regmap
+{
+
+//=============================================================================
+
+// Номер младшего установленного бита (для вычисления сдвига поля).
+constexpr unsigned lowestBit(uint32_t mask, unsigned bit = 0)
+{
+    return (mask & 0x01U) ? bit : lowestBit(mask >> 1, bit + 1);
+}
+
+// Проверить, что биты маски идут подряд.
+constexpr bool isContiguous(uint32_t mask)
+{
+    return ((mask >> lowestBit(mask)) & ((mask >> lowestBit(mask)) + 1)) == 0;
+}
+
+//=============================================================================
+
+// Поле регистра IP-Core, известное на этапе компиляции.
+// Exclusive - в регистре нет других полей, запись не требует чтения.
+template<size_t Offset, uint32_t Mask, typename T = uint32_t, bool Exclusive = false>
+struct field
+{
+    static_assert(Offset % sizeof(uint32_t) == 0, "register offset must be word aligned");
+    static_assert(Mask != 0x00U, "field mask must not be empty");
+    static_assert(isContiguous(Mask), "field mask must be contiguous");
+
+    using value_type = T;
+
+    static constexpr size_t   offset    = Offset;
+    static constexpr size_t   index     = Offset / sizeof(uint32_t);
+    static constexpr uint32_t mask      = Mask;
+    static constexpr unsigned shift     = lowestBit(Mask);
+    static constexpr uint32_t max       = Mask >> lowestBit(Mask);
+    static constexpr bool     exclusive = Exclusive;
+
+    //-------------------------------------------------------------------------
+
+    // Проверить, помещается ли значение в поле.
+    static constexpr bool fits(T value)
+    {
+        return static_cast<uint32_t>(value) <= max;
+    }
+
+    // Упаковать значение в биты регистра.
+    static constexpr uint32_t encode(T value)
+    {
+        return (static_cast<uint32_t>(value) << shift) & mask;
+    }
+
+    // Упаковать значение, проверив диапазон на этапе компиляции.
+    template<T Value>
+    static constexpr uint32_t encode()
+    {
+        static_assert(static_cast<uint32_t>(Value) <= max, "value does not fit the field");
+        return encode(Value);
+    }
+
+    // Извлечь значение из регистра.
+    static constexpr T decode(uint32_t reg)
+    {
+        return static_cast<T>((reg & mask) >> shift);
+    }
+
+    // Заменить биты поля в регистре.
+    static constexpr uint32_t insert(uint32_t reg, T value)
+    {
+        return (reg & ~mask) | encode(value);
+    }
+};
+
+//=============================================================================
+
+// Карта регистров индикатора (см. indicator_regs/indicator_fields драйвера).
+namespace indicator
+{
+
+// Количество регистров.
+constexpr size_t regs = 0x01U;
+
+// Цвет (биты 7-0, единственное поле регистра INDICATOR_OFFSET).
+using color = field<0x00U, 0xFFU, IIndicator::color_t, true>;
+
+static_assert(color::fits(IIndicator::color_t::TURQUOISE_RED),
+              "color_t does not fit the color field");
+
+} // namespace indicator
+
+//=============================================================================
+
+} // namespace regmap
+} // namespace drv
+
+#endif // DRV_INDICATORREGMAP_H
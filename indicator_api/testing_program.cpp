@@ -2,6 +2,8 @@
 #include <string>
 #include "cindicator.h"
 #include "device-library/cdevsym.h"
+#include "cdevsim.h"
+#include "cdevshm.h"
 
 #include <thread>
 #include <chrono>
@@ -116,8 +118,55 @@ void writeTest(drv::IIndicator * test)
     std::this_thread::sleep_for(std::chrono::milliseconds(500));
 }
 
-int main()
+// Прогон на имитации IP-Core (без ПЛИС).
+int simMain()
 {
+    auto sim = new dev::sim::CDevSim();
+    auto ind = new drv::CIndicator();
+
+    sim->setLatency(std::chrono::microseconds(1));
+    sim->setMemIO(ind->region().getIntMemIO());
+    ind->region().setDevIO(sim->getIntDevIO());
+
+    writeTest(ind);
+
+    delete ind;
+    delete sim;
+
+    return 0;
+}
+
+// Прогон через демон indicatord.
+int clientMain(uint32_t device)
+{
+    auto shm = new dev::shm::CDevShm();
+    auto ind = new drv::CIndicator();
+
+    if (!shm->devOpen(device))
+    {
+        print("Can't connect to indicatord");
+        exit(EXIT_FAILURE);
+    }
+
+    shm->setMemIO(ind->region().getIntMemIO());
+    ind->region().setDevIO(shm->getIntDevIO());
+
+    writeTest(ind);
+
+    delete ind;
+    delete shm;
+
+    return 0;
+}
+
+int main(int argc, char * argv[])
+{
+    if (argc > 1 && std::string(argv[1]) == "--sim")
+        return simMain();
+
+    if (argc > 2 && std::string(argv[1]) == "--client")
+        return clientMain(std::stoul(argv[2]));
+
     auto dev = new dev::sym::CDevSym();
     auto ind = new drv::CIndicator();
     dev::sym::IDevSym * sym = dev;